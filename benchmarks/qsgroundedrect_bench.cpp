@@ -0,0 +1,305 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Fatih Uzunoglu <fuzun54@outlook.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "qsgroundedrectangularimagenode.hpp"
+
+#include <QGuiApplication>
+#include <QSGGeometry>
+#include <QSGTexture>
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <vector>
+
+// Every benchmark reports the geometry construction it caused, as
+// vertices per second and geometry (re)allocations per rebuild, taken
+// from QSGRoundedRectangularImageNode::geometryStatistics(). Other heap
+// allocations are not included, tests/tst_allocations covers those.
+
+namespace
+{
+
+using Shape = QSGRoundedRectangularImageNode::Shape;
+using Tessellation = QSGRoundedRectangularImageNode::Tessellation;
+using GeometryStatistics = QSGRoundedRectangularImageNode::GeometryStatistics;
+
+// Stands in for the textures of a window, which is not needed by
+// geometry construction
+class BenchmarkTexture : public QSGTexture
+{
+public:
+    explicit BenchmarkTexture(const QSize& size,
+                              const QRectF& subRect = {0.0, 0.0, 1.0, 1.0},
+                              const bool atlas = false)
+        : m_size(size)
+        , m_subRect(subRect)
+        , m_atlas(atlas) { }
+
+    qint64 comparisonKey() const override
+    {
+        return static_cast<qint64>(reinterpret_cast<quintptr>(this));
+    }
+
+    QSize textureSize() const override
+    {
+        return m_size;
+    }
+
+    bool hasAlphaChannel() const override
+    {
+        return true;
+    }
+
+    bool hasMipmaps() const override
+    {
+        return false;
+    }
+
+    bool isAtlasTexture() const override
+    {
+        return m_atlas;
+    }
+
+    QRectF normalizedTextureSubRect() const override
+    {
+        return m_subRect;
+    }
+
+private:
+    const QSize m_size;
+    const QRectF m_subRect;
+    const bool m_atlas;
+};
+
+std::shared_ptr<QSGTexture> plainTexture()
+{
+    return std::make_shared<BenchmarkTexture>(QSize(256, 256));
+}
+
+// Quarter of a 1024x1024 page
+std::shared_ptr<QSGTexture> atlasTexture()
+{
+    return std::make_shared<BenchmarkTexture>(QSize(256, 256), QRectF(0.25, 0.25, 0.25, 0.25), true);
+}
+
+// Drops every arc from the path cache, keeping its capacity
+void evictPathCache()
+{
+    const qsizetype capacity = QSGRoundedRectangularImageNode::pathCacheCapacity();
+    QSGRoundedRectangularImageNode::setPathCacheCapacity(0);
+    QSGRoundedRectangularImageNode::setPathCacheCapacity(capacity);
+}
+
+void reportGeometryStatistics(benchmark::State& state, const GeometryStatistics& start)
+{
+    const GeometryStatistics end = QSGRoundedRectangularImageNode::geometryStatistics();
+
+    const double rebuilds = end.rebuilds - start.rebuilds;
+    const double vertices = end.vertices - start.vertices;
+    const double allocations = end.allocations - start.allocations;
+
+    state.counters["vertices/s"] = benchmark::Counter(vertices, benchmark::Counter::kIsRate);
+    state.counters["geometryAllocations/rebuild"] = (rebuilds > 0) ? (allocations / rebuilds) : 0.0;
+}
+
+// Rebuilds the geometry of a shape with the given radius, in the
+// same geometry each time, so only the very first one allocates.
+// With a cold cache, the arcs are built again on every rebuild.
+void rebuild(benchmark::State& state, const bool coldCache, const QSGTexture* const atlasTexture = nullptr)
+{
+    const Shape shape {QRectF(0.0, 0.0, 1024.0, 1024.0), static_cast<qreal>(state.range(0))};
+    const Tessellation tessellation {2.0};
+
+    std::unique_ptr<QSGGeometry> geometry(QSGRoundedRectangularImageNode::rebuildGeometry(shape,
+                                                                                          nullptr,
+                                                                                          atlasTexture,
+                                                                                          tessellation));
+
+    const GeometryStatistics start = QSGRoundedRectangularImageNode::geometryStatistics();
+
+    for (auto _ : state)
+    {
+        if (coldCache)
+        {
+            state.PauseTiming();
+            evictPathCache();
+            state.ResumeTiming();
+        }
+
+        QSGGeometry* const rebuilt = QSGRoundedRectangularImageNode::rebuildGeometry(shape,
+                                                                                     geometry.get(),
+                                                                                     atlasTexture,
+                                                                                     tessellation);
+        benchmark::DoNotOptimize(rebuilt);
+        if (rebuilt != geometry.get())
+            geometry.reset(rebuilt);
+    }
+
+    reportGeometryStatistics(state, start);
+}
+
+void BM_RebuildColdCache(benchmark::State& state)
+{
+    rebuild(state, true);
+}
+
+void BM_RebuildWarmCache(benchmark::State& state)
+{
+    rebuild(state, false);
+}
+
+void BM_RebuildAtlas(benchmark::State& state)
+{
+    const std::shared_ptr<QSGTexture> texture = atlasTexture();
+    rebuild(state, false, texture.get());
+}
+
+// Radii from none through the ones served by the compile time table
+// up to ones that need the most segments
+void radiusSweep(benchmark::internal::Benchmark* const benchmark)
+{
+    for (const int radius : {0, 2, 8, 32, 128, 512})
+        benchmark->Arg(radius);
+}
+
+// Fills the vertices of many shapes of growing radii into one
+// buffer, as the batch node does, with and without an atlas sub rect
+void fill(benchmark::State& state, const QRectF& texNormalSubRect)
+{
+    const Tessellation tessellation {2.0};
+
+    std::vector<Shape> shapes;
+    int vertexCount = 0;
+    for (int i = 0; i < 256; ++i)
+    {
+        const Shape shape {QRectF((i % 16) * 64.0, (i / 16) * 64.0, 60.0, 60.0), (i % 30) * 1.0};
+        shapes.push_back(shape);
+        vertexCount += QSGRoundedRectangularImageNode::vertexCount(shape, tessellation);
+    }
+
+    std::vector<QSGGeometry::TexturedPoint2D> points(vertexCount);
+
+    for (auto _ : state)
+    {
+        QSGGeometry::TexturedPoint2D* p = points.data();
+        for (const Shape& shape : shapes)
+        {
+            QSGRoundedRectangularImageNode::fillVertices(p, shape, texNormalSubRect, tessellation);
+            p += QSGRoundedRectangularImageNode::vertexCount(shape, tessellation);
+        }
+
+        benchmark::DoNotOptimize(points.data());
+        benchmark::ClobberMemory();
+    }
+
+    state.counters["vertices/s"] = benchmark::Counter(static_cast<double>(vertexCount) * state.iterations(),
+                                                      benchmark::Counter::kIsRate);
+}
+
+void BM_FillPlain(benchmark::State& state)
+{
+    fill(state, {0.0, 0.0, 1.0, 1.0});
+}
+
+void BM_FillAtlas(benchmark::State& state)
+{
+    fill(state, {0.25, 0.25, 0.25, 0.25});
+}
+
+// Texture and shape changes of many nodes, as when a view scrolls
+// through delegates. Alternating between atlas and plain textures
+// costs a rebuild, alternating the size of the shape another one.
+void churn(benchmark::State& state, const bool changeTexture)
+{
+    const int nodeCount = static_cast<int>(state.range(0));
+
+    const std::shared_ptr<QSGTexture> textures[] = {plainTexture(), atlasTexture()};
+
+    std::vector<std::unique_ptr<QSGRoundedRectangularImageNode>> nodes;
+    nodes.reserve(nodeCount);
+    for (int i = 0; i < nodeCount; ++i)
+    {
+        auto node = std::make_unique<QSGRoundedRectangularImageNode>();
+        node->setTexture(textures[0]);
+        node->setShape({QRectF(0.0, 0.0, 64.0, 64.0), 8.0});
+        nodes.push_back(std::move(node));
+    }
+
+    const GeometryStatistics start = QSGRoundedRectangularImageNode::geometryStatistics();
+
+    int frame = 0;
+    for (auto _ : state)
+    {
+        const int phase = (++frame % 2);
+        const Shape shape {QRectF(0.0, 0.0, 64.0 + (phase * 32.0), 64.0), 8.0 + (phase * 8.0)};
+
+        for (const auto& node : nodes)
+        {
+            if (changeTexture)
+                node->setTexture(textures[phase]);
+            node->setShape(shape);
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * nodeCount);
+    reportGeometryStatistics(state, start);
+}
+
+void BM_SetShapeChurn(benchmark::State& state)
+{
+    churn(state, false);
+}
+
+void BM_SetTextureAndShapeChurn(benchmark::State& state)
+{
+    churn(state, true);
+}
+
+}
+
+BENCHMARK(BM_RebuildColdCache)->Apply(radiusSweep);
+BENCHMARK(BM_RebuildWarmCache)->Apply(radiusSweep);
+BENCHMARK(BM_RebuildAtlas)->Apply(radiusSweep);
+BENCHMARK(BM_FillPlain);
+BENCHMARK(BM_FillAtlas);
+BENCHMARK(BM_SetShapeChurn)->RangeMultiplier(10)->Range(1000, 100000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SetTextureAndShapeChurn)->RangeMultiplier(10)->Range(1000, 100000)->Unit(benchmark::kMillisecond);
+
+int main(int argc, char** argv)
+{
+    // Textures are QObjects, but no window is shown
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+    QGuiApplication application(argc, argv);
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv))
+        return 1;
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+
+    return 0;
+}
@@ -0,0 +1,370 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Fatih Uzunoglu <fuzun54@outlook.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "qsgroundedrectangularimageatlas.hpp"
+
+#include <QImage>
+#include <QQuickWindow>
+#include <QSGTexture>
+
+#include <algorithm>
+#include <utility>
+
+namespace
+{
+
+// Images are padded by repeating their edges,
+// so that linear filtering does not bleed
+// neighbouring images in
+constexpr int padding = 1;
+
+// Shelves are not used for images much shorter than
+// them, which would waste most of the space
+constexpr qreal maximumShelfWaste = 1.5;
+
+}
+
+// Image that the textures are packed in, with shelf packing:
+// the page is divided into rows (shelves) of the height of the
+// first image placed in them. Images are placed in the first
+// shelf that has room for them, and freed space is remembered
+// per shelf to be used again.
+class QSGRoundedRectangularImageAtlas::Page
+{
+public:
+    Page(QQuickWindow* const window, const QSize& size)
+        : m_window(window)
+        , m_image(size, QImage::Format_ARGB32_Premultiplied)
+    {
+        m_image.fill(Qt::transparent);
+    }
+
+    // Returns the rect of the image, excluding the padding,
+    // or a null rect if there is no room for it
+    QRect insert(const QImage& image)
+    {
+        const QSize size = image.size() + QSize(2 * padding, 2 * padding);
+
+        QRect slot;
+
+        for (Shelf& shelf : m_shelves)
+        {
+            if (shelf.height < size.height() || shelf.height > size.height() * maximumShelfWaste)
+                continue;
+
+            slot = shelf.allocate(size, m_image.width());
+            if (!slot.isNull())
+                break;
+        }
+
+        if (slot.isNull())
+        {
+            if (m_shelfTop + size.height() > m_image.height())
+                return {};
+
+            m_shelves.append({m_shelfTop, size.height()});
+            m_shelfTop += size.height();
+
+            slot = m_shelves.last().allocate(size, m_image.width());
+            if (slot.isNull())
+                return {};
+        }
+
+        copy(image, slot);
+        ++m_count;
+        m_dirty = true;
+
+        return slot.adjusted(padding, padding, -padding, -padding);
+    }
+
+    void remove(const QRect& rect)
+    {
+        // Slots start at the top of their shelf
+        const QRect slot = rect.adjusted(-padding, -padding, padding, padding);
+
+        const auto it = std::find_if(m_shelves.begin(), m_shelves.end(), [&slot](const Shelf& shelf) {
+            return shelf.top == slot.top();
+        });
+        assert(it != m_shelves.end());
+
+        it->release(slot.left(), slot.width());
+        --m_count;
+    }
+
+    inline bool isEmpty() const
+    {
+        return m_count == 0;
+    }
+
+    // Texture of the page, created again after images are added
+    QSGTexture* texture()
+    {
+        if (m_dirty || !m_texture)
+        {
+            m_texture.reset(m_window->createTextureFromImage(m_image));
+            m_dirty = false;
+        }
+
+        return m_texture.get();
+    }
+
+    inline QSize size() const
+    {
+        return m_image.size();
+    }
+
+private:
+    struct Shelf
+    {
+        int top;
+        int height;
+        int cursor = 0;
+        int count = 0;
+        // Freed spans, as pairs of left and width, ordered by left
+        // and never adjacent to each other or to the cursor
+        QVector<std::pair<int, int>> free;
+
+        // Slots are as tall as the image, the rest of
+        // the shelf below them is left unused
+        QRect allocate(const QSize& size, const int pageWidth)
+        {
+            assert(size.height() <= height);
+
+            const int width = size.width();
+
+            const auto it = std::find_if(free.begin(), free.end(), [width](const std::pair<int, int>& span) {
+                return span.second >= width;
+            });
+
+            if (it != free.end())
+            {
+                const int left = it->first;
+
+                it->first += width;
+                it->second -= width;
+                if (it->second == 0)
+                    free.erase(it);
+
+                ++count;
+                return {left, top, width, size.height()};
+            }
+
+            if (cursor + width > pageWidth)
+                return {};
+
+            const int left = cursor;
+            cursor += width;
+            ++count;
+            return {left, top, width, size.height()};
+        }
+
+        void release(const int left, const int width)
+        {
+            assert(count > 0);
+
+            // Empty shelves start over, which also
+            // gives them to images of any width
+            if (--count == 0)
+            {
+                cursor = 0;
+                free.clear();
+                return;
+            }
+
+            auto it = std::lower_bound(free.begin(), free.end(), left, [](const std::pair<int, int>& span, const int left) {
+                return span.first < left;
+            });
+
+            it = free.insert(it, {left, width});
+
+            // Merge with the following span, then with the preceding one
+            if (const auto next = it + 1; next != free.end() && it->first + it->second == next->first)
+            {
+                it->second += next->second;
+                free.erase(next);
+            }
+
+            if (it != free.begin())
+            {
+                const auto previous = it - 1;
+                if (previous->first + previous->second == it->first)
+                {
+                    previous->second += it->second;
+                    it = free.erase(it) - 1;
+                }
+            }
+
+            // Give back the space at the end of the shelf directly
+            if (it->first + it->second == cursor)
+            {
+                cursor = it->first;
+                free.erase(it);
+            }
+        }
+    };
+
+    void copy(const QImage& source, const QRect& slot)
+    {
+        const QImage image = source.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+
+        // Rows and columns of the padding repeat the edges
+        for (int y = 0; y < slot.height(); ++y)
+        {
+            const int sourceY = std::clamp(y - padding, 0, image.height() - 1);
+            const auto sourceLine = reinterpret_cast<const QRgb*>(image.constScanLine(sourceY));
+            auto line = reinterpret_cast<QRgb*>(m_image.scanLine(slot.top() + y)) + slot.left();
+
+            for (int x = 0; x < slot.width(); ++x)
+                line[x] = sourceLine[std::clamp(x - padding, 0, image.width() - 1)];
+        }
+    }
+
+    QQuickWindow* const m_window;
+    QImage m_image;
+    std::unique_ptr<QSGTexture> m_texture;
+    QVector<Shelf> m_shelves;
+    int m_shelfTop = 0;
+    int m_count = 0;
+    bool m_dirty = true;
+};
+
+namespace
+{
+
+// Part of a page, forwarding to the texture of the page
+class AtlasTexture : public QSGTexture
+{
+    using Page = QSGRoundedRectangularImageAtlas::Page;
+
+public:
+    AtlasTexture(const std::shared_ptr<Page>& page, const QRect& rect, const bool hasAlphaChannel)
+        : m_page(page)
+        , m_rect(rect)
+        , m_hasAlphaChannel(hasAlphaChannel) { }
+
+    ~AtlasTexture() override
+    {
+        m_page->remove(m_rect);
+    }
+
+    // Same for all textures of the page, so that materials
+    // using them compare equal and get batched
+    qint64 comparisonKey() const override
+    {
+        return static_cast<qint64>(reinterpret_cast<quintptr>(m_page.get()));
+    }
+
+    QRhiTexture* rhiTexture() const override
+    {
+        return m_page->texture()->rhiTexture();
+    }
+
+    QSize textureSize() const override
+    {
+        return m_rect.size();
+    }
+
+    bool hasAlphaChannel() const override
+    {
+        return m_hasAlphaChannel;
+    }
+
+    bool hasMipmaps() const override
+    {
+        return false;
+    }
+
+    bool isAtlasTexture() const override
+    {
+        return true;
+    }
+
+    QRectF normalizedTextureSubRect() const override
+    {
+        const QSizeF size = m_page->size();
+        return {m_rect.x() / size.width(), m_rect.y() / size.height(),
+                m_rect.width() / size.width(), m_rect.height() / size.height()};
+    }
+
+    void commitTextureOperations(QRhi* const rhi, QRhiResourceUpdateBatch* const resourceUpdates) override
+    {
+        QSGTexture* const texture = m_page->texture();
+
+        texture->setFiltering(filtering());
+        texture->setMipmapFiltering(mipmapFiltering());
+        texture->setHorizontalWrapMode(QSGTexture::ClampToEdge);
+        texture->setVerticalWrapMode(QSGTexture::ClampToEdge);
+
+        texture->commitTextureOperations(rhi, resourceUpdates);
+    }
+
+private:
+    const std::shared_ptr<Page> m_page;
+    const QRect m_rect;
+    const bool m_hasAlphaChannel;
+};
+
+}
+
+QSGRoundedRectangularImageAtlas::QSGRoundedRectangularImageAtlas(QQuickWindow* const window, const QSize& pageSize)
+    : m_window(window)
+    , m_pageSize(pageSize)
+{
+    assert(window);
+    assert(!pageSize.isEmpty());
+}
+
+// Pages are kept alive by their textures
+QSGRoundedRectangularImageAtlas::~QSGRoundedRectangularImageAtlas() = default;
+
+std::shared_ptr<QSGTexture> QSGRoundedRectangularImageAtlas::texture(const QImage& image)
+{
+    if (image.isNull())
+        return nullptr;
+
+    if (image.width() + (2 * padding) > m_pageSize.width() || image.height() + (2 * padding) > m_pageSize.height())
+        return nullptr;
+
+    for (const std::shared_ptr<Page>& page : std::as_const(m_pages))
+    {
+        const QRect rect = page->insert(image);
+        if (!rect.isNull())
+            return std::make_shared<AtlasTexture>(page, rect, image.hasAlphaChannel());
+    }
+
+    // Pages that are no longer used by any texture give
+    // their space to the new one instead of staying around
+    m_pages.erase(std::remove_if(m_pages.begin(), m_pages.end(), [](const std::shared_ptr<Page>& page) {
+        return page.use_count() == 1 && page->isEmpty();
+    }), m_pages.end());
+
+    const auto page = std::make_shared<Page>(m_window, m_pageSize);
+    m_pages.append(page);
+
+    const QRect rect = page->insert(image);
+    assert(!rect.isNull());
+
+    return std::make_shared<AtlasTexture>(page, rect, image.hasAlphaChannel());
+}
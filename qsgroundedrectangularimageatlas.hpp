@@ -0,0 +1,65 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Fatih Uzunoglu <fuzun54@outlook.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#ifndef QSGROUNDEDRECTANGULARIMAGEATLAS_HPP
+#define QSGROUNDEDRECTANGULARIMAGEATLAS_HPP
+
+#include <QSize>
+#include <QVector>
+
+#include <memory>
+
+class QImage;
+class QQuickWindow;
+class QSGTexture;
+
+// Packs small images in shared texture pages, so that nodes
+// showing them can share a material and be batched. Returned
+// textures are atlas textures that can be given to the nodes
+// directly, and their space in the page is freed once the last
+// reference to them is gone. Meant to be used on the render
+// thread of the window, such as in `updatePaintNode()`.
+class QSGRoundedRectangularImageAtlas
+{
+public:
+    explicit QSGRoundedRectangularImageAtlas(QQuickWindow* const window, const QSize& pageSize = {1024, 1024});
+    ~QSGRoundedRectangularImageAtlas();
+
+    // Returns nullptr if the image does not fit in a page
+    std::shared_ptr<QSGTexture> texture(const QImage& image);
+
+    inline int pageCount() const
+    {
+        return m_pages.count();
+    }
+
+    class Page;
+
+private:
+    QQuickWindow* const m_window;
+    const QSize m_pageSize;
+    QVector<std::shared_ptr<Page>> m_pages;
+};
+
+#endif // QSGROUNDEDRECTANGULARIMAGEATLAS_HPP
@@ -0,0 +1,279 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Fatih Uzunoglu <fuzun54@outlook.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "qsgroundedrectangularimagebatchnode.hpp"
+
+#include <QSGTextureMaterial>
+#include <QSGOpaqueTextureMaterial>
+
+#include <algorithm>
+#include <utility>
+
+namespace
+{
+
+// Vertices that join two strips with degenerate triangles
+constexpr int jointVertexCount = 2;
+
+}
+
+QSGRoundedRectangularImageBatchNode::QSGRoundedRectangularImageBatchNode()
+{
+    setFlags(QSGGeometryNode::OwnsMaterial |
+             QSGGeometryNode::OwnsOpaqueMaterial |
+             QSGGeometryNode::OwnsGeometry);
+
+    setMaterial(new QSGTextureMaterial);
+    setOpaqueMaterial(new QSGOpaqueTextureMaterial);
+
+    {
+        QSGGeometry* const geometry = new QSGGeometry(QSGGeometry::defaultAttributes_TexturedPoint2D(), 0);
+        geometry->setVertexDataPattern(QSGGeometry::StaticPattern);
+        geometry->setDrawingMode(QSGGeometry::DrawingMode::DrawTriangleStrip);
+        setGeometry(geometry);
+    }
+
+    applyFiltering();
+
+     // Useful for debugging:
+#ifdef QSG_RUNTIME_DESCRIPTION
+    qsgnode_set_description(this, QStringLiteral("RoundedRectangularImageBatch"));
+#endif
+}
+
+QSGTextureMaterial *QSGRoundedRectangularImageBatchNode::material() const
+{
+    return QSGRoundedRectangularImageNode::material_cast<QSGTextureMaterial*>(QSGGeometryNode::material());
+}
+
+QSGOpaqueTextureMaterial *QSGRoundedRectangularImageBatchNode::opaqueMaterial() const
+{
+    return QSGRoundedRectangularImageNode::material_cast<QSGOpaqueTextureMaterial*>(QSGGeometryNode::opaqueMaterial());
+}
+
+void QSGRoundedRectangularImageBatchNode::setSmooth(const bool smooth)
+{
+    if (m_smooth == smooth)
+        return;
+
+    m_smooth = smooth;
+
+    applyFiltering();
+
+    markDirty(QSGNode::DirtyMaterial);
+}
+
+void QSGRoundedRectangularImageBatchNode::setMipmapThreshold(const qreal threshold)
+{
+    if (qFuzzyCompare(m_mipmapThreshold, threshold))
+        return;
+
+    m_mipmapThreshold = threshold;
+
+    if (applyFiltering())
+        markDirty(QSGNode::DirtyMaterial);
+}
+
+qreal QSGRoundedRectangularImageBatchNode::minification(const Item& item) const
+{
+    if (!m_texture || !item.shape.isValid())
+        return 0.0;
+
+    return QSGRoundedRectangularImageNode::minification(*m_texture,
+                                                        item.texNormalSubRect,
+                                                        item.shape.rect.size() * m_tessellation.devicePixelRatio);
+}
+
+bool QSGRoundedRectangularImageBatchNode::applyFiltering()
+{
+    const enum QSGTexture::Filtering filtering = m_smooth ? QSGTexture::Linear : QSGTexture::Nearest;
+
+    const enum QSGTexture::Filtering mipmapFiltering =
+        m_texture ? QSGRoundedRectangularImageNode::mipmapFiltering(*m_texture, m_minification, m_smooth, m_mipmapThreshold)
+                  : QSGTexture::None;
+
+    const bool changed = (material()->filtering() != filtering || material()->mipmapFiltering() != mipmapFiltering);
+
+    material()->setFiltering(filtering);
+    opaqueMaterial()->setFiltering(filtering);
+
+    material()->setMipmapFiltering(mipmapFiltering);
+    opaqueMaterial()->setMipmapFiltering(mipmapFiltering);
+
+    return changed;
+}
+
+void QSGRoundedRectangularImageBatchNode::setTexture(const std::shared_ptr<QSGTexture>& texture)
+{
+    assert(texture);
+
+    // Texture coordinates are given per item,
+    // so there is no need to rebuild the geometry
+    m_texture = texture;
+
+    material()->setTexture(texture.get());
+    opaqueMaterial()->setTexture(texture.get());
+
+    m_minification = 0.0;
+    for (const Item& item : std::as_const(m_items))
+        m_minification = std::max(m_minification, minification(item));
+
+    applyFiltering();
+
+    markDirty(QSGNode::DirtyMaterial);
+}
+
+bool QSGRoundedRectangularImageBatchNode::setTessellation(const Tessellation& tessellation)
+{
+    if (!tessellation.isValid())
+        return false;
+
+    if (m_tessellation == tessellation)
+        return false;
+
+    m_tessellation = tessellation;
+
+    rebuildGeometry();
+
+    return true;
+}
+
+void QSGRoundedRectangularImageBatchNode::setItems(const QVector<Item>& items)
+{
+    if (m_items == items)
+        return;
+
+    m_items = items;
+
+    rebuildGeometry();
+}
+
+bool QSGRoundedRectangularImageBatchNode::setItem(const int index, const Item& item)
+{
+    assert(index >= 0 && index < m_items.count());
+
+    if (m_items.at(index) == item)
+        return false;
+
+    const Range& range = m_ranges.at(index);
+
+    const int count = item.shape.isValid() ? QSGRoundedRectangularImageNode::vertexCount(item.shape, m_tessellation)
+                                           : 0;
+
+    m_items[index] = item;
+
+    if (count != range.count || count == 0)
+    {
+        // The layout changes, so the geometry
+        // needs to be rebuilt from scratch
+        rebuildGeometry();
+        return true;
+    }
+
+    // Only grows until the next rebuild, so that
+    // updating an item stays independent of the rest
+    if (const qreal minification = this->minification(item); minification > m_minification)
+    {
+        m_minification = minification;
+        if (applyFiltering())
+            markDirty(QSGNode::DirtyMaterial);
+    }
+
+    QSGGeometry* const geometry = this->geometry();
+    QSGGeometry::TexturedPoint2D* const points = geometry->vertexDataAsTexturedPoint2D();
+
+    QSGRoundedRectangularImageNode::fillVertices(points + range.offset,
+                                                 item.shape,
+                                                 item.texNormalSubRect,
+                                                 m_tessellation);
+
+    // Update the joints before and after the item:
+    if (range.offset > 0)
+        points[range.offset - 1] = points[range.offset];
+
+    if (range.offset + range.count < geometry->vertexCount())
+        points[range.offset + range.count] = points[range.offset + range.count - 1];
+
+    geometry->markVertexDataDirty();
+    markDirty(QSGNode::DirtyGeometry);
+
+    return true;
+}
+
+void QSGRoundedRectangularImageBatchNode::rebuildGeometry()
+{
+    m_ranges.resize(m_items.count());
+
+    m_minification = 0.0;
+
+    int vertexCount = 0;
+    for (int i = 0; i < m_items.count(); ++i)
+    {
+        const Shape& shape = m_items.at(i).shape;
+        Range& range = m_ranges[i];
+
+        m_minification = std::max(m_minification, minification(m_items.at(i)));
+
+        range.count = shape.isValid() ? QSGRoundedRectangularImageNode::vertexCount(shape, m_tessellation)
+                                      : 0;
+
+        if (range.count > 0 && vertexCount > 0)
+            vertexCount += jointVertexCount;
+
+        range.offset = vertexCount;
+        vertexCount += range.count;
+    }
+
+    QSGGeometry* const geometry = this->geometry();
+    geometry->allocate(vertexCount);
+
+    QSGGeometry::TexturedPoint2D* const points = geometry->vertexDataAsTexturedPoint2D();
+
+    for (int i = 0; i < m_items.count(); ++i)
+    {
+        const Range& range = m_ranges.at(i);
+        if (range.count == 0)
+            continue;
+
+        const Item& item = m_items.at(i);
+        QSGRoundedRectangularImageNode::fillVertices(points + range.offset,
+                                                     item.shape,
+                                                     item.texNormalSubRect,
+                                                     m_tessellation);
+
+        if (range.offset > 0)
+        {
+            // Previous strip is already filled
+            points[range.offset - 2] = points[range.offset - 3];
+            points[range.offset - 1] = points[range.offset];
+        }
+    }
+
+    geometry->markVertexDataDirty();
+    markDirty(QSGNode::DirtyGeometry);
+
+    if (applyFiltering())
+        markDirty(QSGNode::DirtyMaterial);
+}
@@ -0,0 +1,120 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Fatih Uzunoglu <fuzun54@outlook.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#ifndef QSGROUNDEDRECTANGULARIMAGEBATCHNODE_HPP
+#define QSGROUNDEDRECTANGULARIMAGEBATCHNODE_HPP
+
+#include "qsgroundedrectangularimagenode.hpp"
+
+#include <QVector>
+
+#include <memory>
+
+// Packs many rounded rectangular images that share a single
+// (typically atlas) texture into one geometry. Strips of the
+// items are joined with degenerate triangles, so updating an
+// item costs as much as its own vertices as long as its vertex
+// count does not change.
+class QSGRoundedRectangularImageBatchNode : public QSGGeometryNode
+{
+public:
+    using Shape = QSGRoundedRectangularImageNode::Shape;
+    using Tessellation = QSGRoundedRectangularImageNode::Tessellation;
+
+    struct Item
+    {
+        Shape shape;
+
+        // Sub rectangle of the texture that the item
+        // displays, such as `normalizedTextureSubRect()`
+        // of an atlas texture:
+        QRectF texNormalSubRect {0.0, 0.0, 1.0, 1.0};
+
+        constexpr bool operator ==(const Item& b) const
+        {
+            return (shape == b.shape && texNormalSubRect == b.texNormalSubRect);
+        }
+    };
+
+    QSGRoundedRectangularImageBatchNode();
+
+    // For convenience:
+    QSGTextureMaterial* material() const;
+    QSGOpaqueTextureMaterial* opaqueMaterial() const;
+
+    void setSmooth(const bool smooth);
+
+    // Same as QSGRoundedRectangularImageNode::mipmapThreshold(),
+    // applied to the most minified item
+    inline constexpr qreal mipmapThreshold() const
+    {
+        return m_mipmapThreshold;
+    }
+
+    void setMipmapThreshold(const qreal threshold);
+    void setTexture(const std::shared_ptr<QSGTexture>& texture);
+
+    inline constexpr Tessellation tessellation() const
+    {
+        return m_tessellation;
+    }
+
+    bool setTessellation(const Tessellation& tessellation);
+
+    inline int count() const
+    {
+        return m_items.count();
+    }
+
+    inline const Item& item(const int index) const
+    {
+        return m_items.at(index);
+    }
+
+    // Items with invalid shape are not drawn
+    void setItems(const QVector<Item>& items);
+    bool setItem(const int index, const Item& item);
+
+private:
+    struct Range
+    {
+        int offset = 0;
+        int count = 0;
+    };
+
+    void rebuildGeometry();
+    qreal minification(const Item& item) const;
+    bool applyFiltering();
+
+    std::shared_ptr<QSGTexture> m_texture;
+    QVector<Item> m_items;
+    QVector<Range> m_ranges;
+    Tessellation m_tessellation;
+    // Of the most minified item
+    qreal m_minification = 0.0;
+    qreal m_mipmapThreshold = 2.0;
+    bool m_smooth = true;
+};
+
+#endif // QSGROUNDEDRECTANGULARIMAGEBATCHNODE_HPP
@@ -0,0 +1,148 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Fatih Uzunoglu <fuzun54@outlook.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "qsgroundedrectangularimagenode.hpp"
+
+#include <QSGTexture>
+#include <QSet>
+#include <QVector>
+#include <QtConcurrent/QtConcurrentMap>
+
+#include <utility>
+
+// Kept apart from the rest of the node, so that only builds
+// that use setShapes() depend on Qt Concurrent
+
+namespace
+{
+
+// Fewer shape updates than this are done serially by setShapes()
+constexpr qsizetype minimumParallelUpdateCount = 64;
+
+}
+
+void QSGRoundedRectangularImageNode::setShapes(const QVector<ShapeUpdate>& updates)
+{
+#ifndef NDEBUG
+    {
+        // Workers would write the same geometry at once
+        QSet<const QSGRoundedRectangularImageNode*> nodes;
+        nodes.reserve(updates.size());
+
+        for (const ShapeUpdate& update : updates)
+        {
+            assert(!nodes.contains(update.node)); // node appears more than once
+            nodes.insert(update.node);
+        }
+    }
+#endif
+
+    // Not worth the overhead of the thread pool
+    if (updates.size() < minimumParallelUpdateCount)
+    {
+        for (const ShapeUpdate& update : updates)
+            update.node->setShape(update.shape);
+        return;
+    }
+
+    struct Job
+    {
+        QSGRoundedRectangularImageNode* node;
+        Shape shape;
+        QSGGeometry* geometry;
+        const QSGTexture* atlasTexture;
+        Tessellation tessellation;
+        QSGGeometry* rebuiltGeometry = nullptr;
+    };
+
+    QVector<Job> jobs;
+    jobs.reserve(updates.size());
+
+    for (const ShapeUpdate& update : updates)
+    {
+        QSGRoundedRectangularImageNode* const node = update.node;
+        const Shape& shape = update.shape;
+        assert(node);
+
+        // Only own geometry of tessellated nodes that needs to be rebuilt
+        // is built in parallel, the rest is cheap or is not built now
+        // (nodes without a texture keep the shape until they get one)
+        if (node->updatesDeferred() ||
+            node->m_mode != Mode::Tessellated ||
+            node->m_geometrySharing ||
+            node->m_sharedGeometry ||
+            !node->m_texture ||
+            !shape.isValid() ||
+            node->m_shape == shape ||
+            node->isTranslation(shape))
+        {
+            node->setShape(shape);
+            continue;
+        }
+
+        node->startCoarsePhase();
+
+        jobs.append({node,
+                     shape,
+                     node->reusableGeometry(),
+                     node->m_texture->isAtlasTexture() ? node->m_texture.get() : nullptr,
+                     node->effectiveTessellation()});
+    }
+
+    // Each job has its own geometry, and the cache is thread safe
+    QtConcurrent::blockingMap(jobs, [](Job& job) {
+        job.rebuiltGeometry = rebuildGeometry(job.shape,
+                                              job.geometry,
+                                              job.atlasTexture,
+                                              job.tessellation,
+                                              job.node->m_topology);
+    });
+
+    // Nodes are only touched on the calling thread
+    for (const Job& job : std::as_const(jobs))
+    {
+        QSGRoundedRectangularImageNode* const node = job.node;
+
+        if (!job.rebuiltGeometry)
+            continue;
+
+        if (job.rebuiltGeometry == job.geometry)
+            node->markDirty(QSGNode::DirtyGeometry);
+        else
+            node->setGeometry(job.rebuiltGeometry); // Deletes the old geometry
+
+        node->m_shape = job.shape;
+        ++node->m_rebuildCount;
+
+        if (node->applyFiltering())
+            node->markDirty(QSGNode::DirtyMaterial);
+
+        node->updateMemoryAccounting();
+    }
+
+    // Once all of the geometries are accounted
+    for (const Job& job : std::as_const(jobs))
+        job.node->enforceMemoryBudget();
+}
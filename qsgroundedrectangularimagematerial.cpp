@@ -0,0 +1,202 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Fatih Uzunoglu <fuzun54@outlook.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "qsgroundedrectangularimagematerial.hpp"
+
+#include <QSGMaterialShader>
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+
+class Shader : public QSGMaterialShader
+{
+    // Offsets in the uniform buffer (std140):
+    enum : int
+    {
+        MatrixOffset = 0,
+        RectOffset = 64,
+        RadiiOffset = 80,
+        OpacityOffset = 96
+    };
+
+    enum : int
+    {
+        SourceBinding = 1
+    };
+
+public:
+    Shader()
+    {
+        setShaderFileName(VertexStage, QStringLiteral(":/qsgroundedrectangularimagenode/shaders/roundedrectangularimage.vert.qsb"));
+        setShaderFileName(FragmentStage, QStringLiteral(":/qsgroundedrectangularimagenode/shaders/roundedrectangularimage.frag.qsb"));
+    }
+
+    bool updateUniformData(RenderState& state, QSGMaterial* newMaterial, QSGMaterial* oldMaterial) override
+    {
+        const auto material = static_cast<QSGRoundedRectangularImageMaterial*>(newMaterial);
+        const auto previousMaterial = static_cast<QSGRoundedRectangularImageMaterial*>(oldMaterial);
+
+        char* const data = state.uniformData()->data();
+        bool changed = false;
+
+        if (state.isMatrixDirty())
+        {
+            const QMatrix4x4 matrix = state.combinedMatrix();
+            std::memcpy(data + MatrixOffset, matrix.constData(), 64);
+            changed = true;
+        }
+
+        if (!previousMaterial ||
+            previousMaterial->rect() != material->rect() ||
+            previousMaterial->radii() != material->radii())
+        {
+            const QRectF& rect = material->rect();
+            const QSGRoundedRectangularImageMaterial::Radii& radii = material->radii();
+            const float values[] = {static_cast<float>(rect.x()),
+                                    static_cast<float>(rect.y()),
+                                    static_cast<float>(rect.width()),
+                                    static_cast<float>(rect.height()),
+                                    static_cast<float>(radii[0]),
+                                    static_cast<float>(radii[1]),
+                                    static_cast<float>(radii[2]),
+                                    static_cast<float>(radii[3])};
+            static_assert(RectOffset + (4 * sizeof(float)) == RadiiOffset);
+            std::memcpy(data + RectOffset, values, sizeof(values));
+            changed = true;
+        }
+
+        if (state.isOpacityDirty())
+        {
+            const float opacity = state.opacity();
+            std::memcpy(data + OpacityOffset, &opacity, sizeof(opacity));
+            changed = true;
+        }
+
+        return changed;
+    }
+
+    void updateSampledImage(RenderState& state,
+                            const int binding,
+                            QSGTexture** const texture,
+                            QSGMaterial* const newMaterial,
+                            QSGMaterial*) override
+    {
+        if (binding != SourceBinding)
+            return;
+
+        const auto material = static_cast<QSGRoundedRectangularImageMaterial*>(newMaterial);
+
+        QSGTexture* const sourceTexture = material->texture();
+        if (sourceTexture)
+        {
+            sourceTexture->setFiltering(material->filtering());
+            sourceTexture->setMipmapFiltering(material->mipmapFiltering());
+            sourceTexture->commitTextureOperations(state.rhi(), state.resourceUpdateBatch());
+        }
+
+        *texture = sourceTexture;
+    }
+};
+
+}
+
+QSGRoundedRectangularImageMaterial::QSGRoundedRectangularImageMaterial()
+{
+    // The shader needs the coordinates of the geometry as they
+    // are, so the renderer must not merge the geometry with
+    // others in a different coordinate system:
+    setFlag(QSGMaterial::Blending | QSGMaterial::RequiresFullMatrix);
+}
+
+QSGMaterialType* QSGRoundedRectangularImageMaterial::type() const
+{
+    static QSGMaterialType type;
+    return &type;
+}
+
+QSGMaterialShader* QSGRoundedRectangularImageMaterial::createShader(QSGRendererInterface::RenderMode) const
+{
+    return new Shader;
+}
+
+int QSGRoundedRectangularImageMaterial::compare(const QSGMaterial* const other) const
+{
+    const auto material = static_cast<const QSGRoundedRectangularImageMaterial*>(other);
+
+    {
+        const qint64 a = m_texture ? m_texture->comparisonKey() : 0;
+        const qint64 b = material->m_texture ? material->m_texture->comparisonKey() : 0;
+        if (a != b)
+            return (a < b) ? -1 : 1;
+    }
+
+    if (m_filtering != material->m_filtering)
+        return (m_filtering < material->m_filtering) ? -1 : 1;
+
+    if (m_mipmapFiltering != material->m_mipmapFiltering)
+        return (m_mipmapFiltering < material->m_mipmapFiltering) ? -1 : 1;
+
+    // Uniforms differ per node:
+    {
+        const qreal a[] = {m_rect.x(), m_rect.y(), m_rect.width(), m_rect.height(),
+                           m_radii[0], m_radii[1], m_radii[2], m_radii[3]};
+        const qreal b[] = {material->m_rect.x(), material->m_rect.y(), material->m_rect.width(), material->m_rect.height(),
+                           material->m_radii[0], material->m_radii[1], material->m_radii[2], material->m_radii[3]};
+
+        const auto mismatch = std::mismatch(std::begin(a), std::end(a), std::begin(b));
+        if (mismatch.first != std::end(a))
+            return (*mismatch.first < *mismatch.second) ? -1 : 1;
+    }
+
+    return 0;
+}
+
+void QSGRoundedRectangularImageMaterial::setTexture(QSGTexture* const texture)
+{
+    m_texture = texture;
+}
+
+void QSGRoundedRectangularImageMaterial::setFiltering(const QSGTexture::Filtering filtering)
+{
+    m_filtering = filtering;
+}
+
+void QSGRoundedRectangularImageMaterial::setMipmapFiltering(const QSGTexture::Filtering filtering)
+{
+    m_mipmapFiltering = filtering;
+}
+
+void QSGRoundedRectangularImageMaterial::setShape(const QRectF& rect, const Radii& radii)
+{
+    m_rect = rect;
+
+    // Same as what the tessellated geometry does:
+    const qreal maximumRadius = std::min(rect.width(), rect.height()) / 2;
+    for (size_t i = 0; i < m_radii.size(); ++i)
+        m_radii[i] = std::min(radii[i], maximumRadius);
+}
@@ -0,0 +1,92 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Fatih Uzunoglu <fuzun54@outlook.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#ifndef QSGROUNDEDRECTANGULARIMAGEMATERIAL_HPP
+#define QSGROUNDEDRECTANGULARIMAGEMATERIAL_HPP
+
+#include <QSGMaterial>
+#include <QSGTexture>
+
+#include <array>
+
+// Textured material that rounds the corners of the rectangle it
+// is drawn on in the fragment shader, using the signed distance
+// to the rounded rectangle. Edges are antialiased analytically,
+// and changing the radius does not require a new geometry.
+class QSGRoundedRectangularImageMaterial : public QSGMaterial
+{
+public:
+    QSGRoundedRectangularImageMaterial();
+
+    QSGMaterialType* type() const override;
+    QSGMaterialShader* createShader(QSGRendererInterface::RenderMode renderMode) const override;
+    int compare(const QSGMaterial* other) const override;
+
+    inline QSGTexture* texture() const
+    {
+        return m_texture;
+    }
+
+    void setTexture(QSGTexture* const texture);
+
+    inline QSGTexture::Filtering filtering() const
+    {
+        return m_filtering;
+    }
+
+    void setFiltering(const QSGTexture::Filtering filtering);
+
+    inline QSGTexture::Filtering mipmapFiltering() const
+    {
+        return m_mipmapFiltering;
+    }
+
+    void setMipmapFiltering(const QSGTexture::Filtering filtering);
+
+    inline QRectF rect() const
+    {
+        return m_rect;
+    }
+
+    using Radii = std::array<qreal, 4>;
+
+    inline const Radii& radii() const
+    {
+        return m_radii;
+    }
+
+    // Rectangle is in the coordinate system of the geometry.
+    // Radii are of the top left, top right, bottom right and
+    // bottom left corners, in order.
+    void setShape(const QRectF& rect, const Radii& radii);
+
+private:
+    QSGTexture* m_texture = nullptr;
+    QSGTexture::Filtering m_filtering = QSGTexture::Nearest;
+    QSGTexture::Filtering m_mipmapFiltering = QSGTexture::None;
+    QRectF m_rect;
+    Radii m_radii {};
+};
+
+#endif // QSGROUNDEDRECTANGULARIMAGEMATERIAL_HPP
@@ -24,114 +24,1866 @@
  */
 
 #include "qsgroundedrectangularimagenode.hpp"
+#include "qsgroundedrectangularimagematerial.hpp"
 
 #include <QSGTextureMaterial>
 #include <QSGOpaqueTextureMaterial>
+#include <QSGTexture>
 
 #include <QCache>
+#include <QHash>
 #include <QVector>
-#include <QPainterPath>
+#include <QVarLengthArray>
+#include <QMutex>
+#include <QtMath>
 
-template<class T>
-T QSGRoundedRectangularImageNode::material_cast(QSGMaterial* const material)
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <utility>
+
+// Zones around the stages of geometry construction, when built with
+// QSGROUNDEDRECTANGULARIMAGENODE_INSTRUMENTATION defined. They are
+// Tracy zones if Tracy is enabled, otherwise their durations are
+// logged in the "qt.scenegraph.roundedrectangularimagenode" category.
+#ifdef QSGROUNDEDRECTANGULARIMAGENODE_INSTRUMENTATION
+#ifdef TRACY_ENABLE
+#include <tracy/Tracy.hpp>
+
+#define QSGROUNDEDRECTANGULARIMAGENODE_ZONE(name) ZoneScopedN(name)
+#else
+#include <QElapsedTimer>
+#include <QLoggingCategory>
+
+Q_LOGGING_CATEGORY(lcRoundedRectangularImageNode, "qt.scenegraph.roundedrectangularimagenode", QtWarningMsg)
+
+namespace
+{
+
+class InstrumentationZone
+{
+public:
+    explicit InstrumentationZone(const char* const name)
+        : m_name(name)
+    {
+        m_timer.start();
+    }
+
+    ~InstrumentationZone()
+    {
+        qCDebug(lcRoundedRectangularImageNode).nospace() << m_name << ": " << m_timer.nsecsElapsed() << " ns";
+    }
+
+private:
+    const char* const m_name;
+    QElapsedTimer m_timer;
+};
+
+}
+
+#define QSGROUNDEDRECTANGULARIMAGENODE_ZONE(name) const InstrumentationZone instrumentationZone(name)
+#endif
+#else
+#define QSGROUNDEDRECTANGULARIMAGENODE_ZONE(name)
+#endif
+
+namespace
+{
+
+constexpr int maximumCornerSegmentCount = 64;
+
+// Corners of typical sizes, with the default tolerance,
+// do not need more segments than this
+constexpr int typicalCornerSegmentCount = 16;
+
+// Kept in single precision and as structure of arrays, the
+// same precision that the vertices have and the layout that
+// lets the fill loop be vectorized. Cached arcs are above the
+// compile time table, so their points are not kept inline but
+// in one allocation of the exact size, cosines followed by sines.
+struct UnitCornerArc
+{
+    explicit UnitCornerArc(const int segmentCount)
+        : m_count(segmentCount + 1)
+        , m_points(new float[2 * m_count])
+    {
+        float* const cos = m_points.get();
+        float* const sin = cos + m_count;
+
+        for (int i = 0; i <= segmentCount; ++i)
+        {
+            const qreal angle = (M_PI_2 * i) / segmentCount;
+            cos[i] = std::cos(angle);
+            sin[i] = std::sin(angle);
+        }
+    }
+
+    inline int count() const
+    {
+        return m_count;
+    }
+
+    inline const float* cos() const
+    {
+        return m_points.get();
+    }
+
+    inline const float* sin() const
+    {
+        return m_points.get() + m_count;
+    }
+
+private:
+    int m_count;
+    std::unique_ptr<float[]> m_points;
+};
+
+using SharedUnitCornerArc = std::shared_ptr<const UnitCornerArc>;
+
+// Taylor series, accurate well beyond single
+// precision within the first quadrant
+constexpr double constexprSin(const double x)
+{
+    double term = x;
+    double sum = x;
+    for (int i = 1; i < 12; ++i)
+    {
+        term *= -(x * x) / ((2 * i) * ((2 * i) + 1));
+        sum += term;
+    }
+    return sum;
+}
+
+constexpr double constexprCos(const double x)
+{
+    double term = 1.0;
+    double sum = 1.0;
+    for (int i = 1; i < 12; ++i)
+    {
+        term *= -(x * x) / (((2 * i) - 1) * (2 * i));
+        sum += term;
+    }
+    return sum;
+}
+
+// Unit arcs of the segment counts up to `MaximumSegmentCount`, the
+// same as what UnitCornerArc holds, built at compile time. Corners
+// with these segment counts need neither the cache nor any
+// trigonometry at run time.
+template<int MaximumSegmentCount>
+struct UnitCornerArcTable
+{
+    static constexpr int pointCount = (MaximumSegmentCount * (MaximumSegmentCount + 3)) / 2;
+
+    // Index of the first point of each segment count
+    std::array<int, MaximumSegmentCount + 1> offsets {};
+    std::array<float, pointCount> cos {};
+    std::array<float, pointCount> sin {};
+
+    constexpr UnitCornerArcTable()
+    {
+        int offset = 0;
+        for (int segmentCount = 1; segmentCount <= MaximumSegmentCount; ++segmentCount)
+        {
+            offsets[segmentCount] = offset;
+
+            for (int i = 0; i <= segmentCount; ++i)
+            {
+                const double angle = (M_PI_2 * i) / segmentCount;
+                cos[offset + i] = static_cast<float>(constexprCos(angle));
+                sin[offset + i] = static_cast<float>(constexprSin(angle));
+            }
+
+            offset += segmentCount + 1;
+        }
+    }
+};
+
+// Segment counts served from the compile time table, by default the
+// same as `typicalCornerSegmentCount`. The table takes about a kilobyte.
+#ifndef QSGROUNDEDRECTANGULARIMAGENODE_CONSTEXPR_SEGMENTS
+#define QSGROUNDEDRECTANGULARIMAGENODE_CONSTEXPR_SEGMENTS 16
+#endif
+
+constexpr int constexprCornerSegmentCount = QSGROUNDEDRECTANGULARIMAGENODE_CONSTEXPR_SEGMENTS;
+static_assert(constexprCornerSegmentCount >= 0 && constexprCornerSegmentCount <= maximumCornerSegmentCount);
+
+constexpr UnitCornerArcTable<constexprCornerSegmentCount> unitCornerArcTable;
+
+// Holds the points of a quarter of the unit circle divided into
+// `segmentCount` segments, from angle 0 to 90 degrees. Corners of any
+// rounded rectangle with the same segment count can be derived from
+// them by scaling and translating, so the size, the radius and the
+// position of the shape need not be part of the cache key.
+//
+// Arcs are immutable once created. They are shared between threads
+// through a tier guarded by a mutex, and each thread (such as the
+// render thread of each window when threaded render loop is used)
+// keeps its own tier that is accessed without any locking. The shared
+// tier is only consulted when the local tier misses, and the local
+// tiers drop their arcs when the shared tier evicts, so the capacity
+// of the shared tier also bounds the local tiers.
+class UnitCornerArcCache
+{
+public:
+    using Statistics = QSGRoundedRectangularImageNode::PathCacheStatistics;
+
+    static UnitCornerArcCache& instance()
+    {
+        static UnitCornerArcCache cache;
+        return cache;
+    }
+
+    SharedUnitCornerArc arc(const int segmentCount)
+    {
+        assert(segmentCount > 0 && segmentCount <= maximumCornerSegmentCount);
+
+        struct LocalArcs
+        {
+            quint64 generation = 0;
+            std::array<SharedUnitCornerArc, maximumCornerSegmentCount + 1> arcs;
+        };
+
+        QSGROUNDEDRECTANGULARIMAGENODE_ZONE("RoundedRectangularImage path cache lookup");
+
+        thread_local LocalArcs localArcs;
+
+        {
+            const quint64 generation = m_generation.load(std::memory_order_acquire);
+            if (localArcs.generation != generation)
+            {
+                localArcs.arcs = {};
+                localArcs.generation = generation;
+            }
+        }
+
+        SharedUnitCornerArc& localArc = localArcs.arcs[segmentCount];
+        if (localArc)
+        {
+            m_hits.fetch_add(1, std::memory_order_relaxed);
+            return localArc;
+        }
+
+        const QMutexLocker locker(&m_mutex);
+
+        // QCache::object() manipulates the cache, so it is
+        // not possible to use a read lock here. This is not a
+        // problem, the local tier is not going to miss often
+        if (const SharedUnitCornerArc* const sharedArc = m_arcs.object(segmentCount))
+        {
+            m_hits.fetch_add(1, std::memory_order_relaxed);
+            localArc = *sharedArc;
+            return localArc;
+        }
+
+        m_misses.fetch_add(1, std::memory_order_relaxed);
+
+        const SharedUnitCornerArc arc = std::make_shared<const UnitCornerArc>(segmentCount);
+
+        // Arcs that do not fit in the shared tier
+        // are not kept in the local tier either:
+        if (insert(segmentCount, arc))
+            localArc = arc;
+
+        return arc;
+    }
+
+    // Makes sure that the arc is in the shared tier, without
+    // touching the local tier of the calling thread
+    void prewarm(const int segmentCount)
+    {
+        assert(segmentCount > 0 && segmentCount <= maximumCornerSegmentCount);
+
+        const QMutexLocker locker(&m_mutex);
+
+        if (m_arcs.contains(segmentCount))
+            return;
+
+        m_misses.fetch_add(1, std::memory_order_relaxed);
+        insert(segmentCount, std::make_shared<const UnitCornerArc>(segmentCount));
+    }
+
+    void setCapacity(const qsizetype bytes)
+    {
+        const QMutexLocker locker(&m_mutex);
+
+        const auto count = m_arcs.count();
+        m_arcs.setMaxCost(bytes);
+        evicted(count - m_arcs.count());
+    }
+
+    // Kept apart from the statistics, so that
+    // reading it does not take the lock
+    qsizetype residentBytes() const
+    {
+        return m_residentBytes.load(std::memory_order_relaxed);
+    }
+
+    // Evicts the least recently used arcs until the cache takes
+    // at most the given size, without changing its capacity
+    void trim(const qsizetype bytes)
+    {
+        const QMutexLocker locker(&m_mutex);
+
+        const auto count = m_arcs.count();
+        const qsizetype capacity = m_arcs.maxCost();
+        m_arcs.setMaxCost(std::clamp<qsizetype>(bytes, 0, capacity));
+        m_arcs.setMaxCost(capacity);
+        evicted(count - m_arcs.count());
+    }
+
+    qsizetype capacity() const
+    {
+        const QMutexLocker locker(&m_mutex);
+        return m_arcs.maxCost();
+    }
+
+    Statistics statistics() const
+    {
+        Statistics statistics;
+        statistics.hits = m_hits.load(std::memory_order_relaxed);
+        statistics.misses = m_misses.load(std::memory_order_relaxed);
+        statistics.evictions = m_evictions.load(std::memory_order_relaxed);
+
+        {
+            const QMutexLocker locker(&m_mutex);
+            statistics.residentBytes = m_arcs.totalCost();
+            statistics.capacity = m_arcs.maxCost();
+        }
+
+        return statistics;
+    }
+
+private:
+    // Every possible arc fits with the default capacity
+    static constexpr qsizetype defaultCapacity = 64 * 1024;
+
+    UnitCornerArcCache()
+        : m_arcs(defaultCapacity) { }
+
+    static qsizetype cost(const UnitCornerArc& arc)
+    {
+        return arc.count() * (sizeof(float) * 2);
+    }
+
+    bool insert(const int segmentCount, const SharedUnitCornerArc& arc)
+    {
+        const qsizetype cost = UnitCornerArcCache::cost(*arc);
+
+        const auto count = m_arcs.count();
+        // Deletes the object if it can not be inserted:
+        const bool inserted = m_arcs.insert(segmentCount, new SharedUnitCornerArc(arc), cost);
+        evicted(count - m_arcs.count() + (inserted ? 1 : 0));
+
+        return inserted;
+    }
+
+    // Also called after insertions, so that
+    // the resident size is kept up to date
+    void evicted(const qsizetype count)
+    {
+        m_residentBytes.store(m_arcs.totalCost(), std::memory_order_relaxed);
+
+        if (count <= 0)
+            return;
+
+        m_evictions.fetch_add(count, std::memory_order_relaxed);
+
+        // Let the local tiers know that
+        // they should drop their arcs:
+        m_generation.fetch_add(1, std::memory_order_release);
+    }
+
+    mutable QMutex m_mutex;
+    QCache<int, SharedUnitCornerArc> m_arcs;
+
+    std::atomic<qsizetype> m_residentBytes {0};
+    std::atomic<quint64> m_generation {0};
+    std::atomic<quint64> m_hits {0};
+    std::atomic<quint64> m_misses {0};
+    std::atomic<quint64> m_evictions {0};
+};
+
+// Number of segments an arc with the given radius (in logical
+// pixels) and sweep angle is divided into, so that the chords
+// stay within the tolerance of the arc
+int arcSegmentCount(const QSGRoundedRectangularImageNode::Tessellation& tessellation,
+                    const qreal radius,
+                    const qreal sweepAngle,
+                    const int minimum,
+                    const int maximum)
+{
+    assert(tessellation.isValid());
+
+    // Radius as it appears on the screen:
+    const qreal deviceRadius = radius * tessellation.devicePixelRatio;
+
+    if (deviceRadius <= tessellation.tolerance)
+        return minimum;
+
+    // A chord spanning the angle `a` deviates from the
+    // arc by `radius * (1 - cos(a / 2))` at most:
+    const qreal maximumAngle = 2.0 * std::acos(1.0 - tessellation.tolerance / deviceRadius);
+    return qBound(minimum, static_cast<int>(std::ceil(sweepAngle / maximumAngle)), maximum);
+}
+
+// Counters behind QSGRoundedRectangularImageNode::geometryStatistics()
+struct GeometryCounters
+{
+    std::atomic<quint64> rebuilds {0};
+    std::atomic<quint64> vertices {0};
+    std::atomic<quint64> allocations {0};
+};
+
+GeometryCounters geometryCounters;
+
+qsizetype geometrySize(const QSGGeometry& geometry)
+{
+    return sizeof(QSGGeometry) +
+           (geometry.vertexCount() * geometry.sizeOfVertex()) +
+           (geometry.indexCount() * geometry.sizeOfIndex());
+}
+
+}
+
+struct QSGRoundedRectangularImageNode::MemoryCounters
+{
+    std::atomic<qsizetype> geometryBytes {0};
+    std::atomic<qsizetype> materialBytes {0};
+    std::atomic<qsizetype> nodeCount {0};
+
+    void add(const qsizetype geometryBytes, const qsizetype materialBytes, const qsizetype nodeCount)
+    {
+        this->geometryBytes.fetch_add(geometryBytes, std::memory_order_relaxed);
+        this->materialBytes.fetch_add(materialBytes, std::memory_order_relaxed);
+        this->nodeCount.fetch_add(nodeCount, std::memory_order_relaxed);
+    }
+
+    QSGRoundedRectangularImageNode::MemoryStatistics toStatistics() const
+    {
+        QSGRoundedRectangularImageNode::MemoryStatistics statistics;
+        statistics.geometryBytes = geometryBytes.load(std::memory_order_relaxed);
+        statistics.materialBytes = materialBytes.load(std::memory_order_relaxed);
+        statistics.nodeCount = nodeCount.load(std::memory_order_relaxed);
+        return statistics;
+    }
+};
+
+namespace
+{
+
+// The path cache keeps this part of the memory budget
+// even when the budget is exceeded
+constexpr qsizetype pathCacheBudgetDivisor = 8;
+
+// Memory used by the nodes, in total and per window. The sizes of
+// the path cache and of the shared geometries are only known in
+// total, as they are not specific to a window.
+//
+// Updates only touch atomics: nodes hold the counters of their
+// window, so the lock is only taken when a node changes windows
+// or when the statistics of a window are looked up.
+class MemoryAccounting
+{
+public:
+    using Statistics = QSGRoundedRectangularImageNode::MemoryStatistics;
+    using Counters = QSGRoundedRectangularImageNode::MemoryCounters;
+
+    static MemoryAccounting& instance()
+    {
+        static MemoryAccounting accounting;
+        return accounting;
+    }
+
+    // Counters of the window, kept alive by the nodes accounted to it
+    std::shared_ptr<Counters> counters(const QQuickWindow* const window)
+    {
+        if (!window)
+            return m_unassigned;
+
+        const QMutexLocker locker(&m_mutex);
+
+        std::shared_ptr<Counters> counters = m_windows.value(window).lock();
+        if (!counters)
+        {
+            // Windows whose nodes are all gone
+            // are dropped along the way
+            using Iterator = QHash<const QQuickWindow*, std::weak_ptr<Counters>>::iterator;
+            m_windows.removeIf([](const Iterator it) { return it.value().expired(); });
+
+            counters = std::make_shared<Counters>();
+            m_windows.insert(window, counters);
+        }
+
+        return counters;
+    }
+
+    void update(Counters& counters,
+                const qsizetype geometryBytes,
+                const qsizetype materialBytes,
+                const qsizetype nodeCount)
+    {
+        counters.add(geometryBytes, materialBytes, nodeCount);
+        m_total.add(geometryBytes, materialBytes, nodeCount);
+    }
+
+    void updateSharedGeometry(const qsizetype bytes)
+    {
+        m_sharedGeometryBytes.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    Statistics statistics() const
+    {
+        Statistics statistics = m_total.toStatistics();
+
+        statistics.sharedGeometryBytes = m_sharedGeometryBytes.load(std::memory_order_relaxed);
+        statistics.pathCacheBytes = UnitCornerArcCache::instance().residentBytes();
+
+        return statistics;
+    }
+
+    Statistics statistics(const QQuickWindow* const window) const
+    {
+        if (!window)
+            return m_unassigned->toStatistics();
+
+        const QMutexLocker locker(&m_mutex);
+
+        if (const std::shared_ptr<Counters> counters = m_windows.value(window).lock())
+            return counters->toStatistics();
+
+        return {};
+    }
+
+    void setBudget(const qsizetype bytes)
+    {
+        m_budget.store(bytes, std::memory_order_relaxed);
+    }
+
+    qsizetype budget() const
+    {
+        return m_budget.load(std::memory_order_relaxed);
+    }
+
+    // Bytes over the budget, not positive if within
+    qsizetype excess() const
+    {
+        const qsizetype budget = this->budget();
+        if (budget <= 0)
+            return 0;
+
+        return statistics().totalBytes() - budget;
+    }
+
+private:
+    mutable QMutex m_mutex;
+    QHash<const QQuickWindow*, std::weak_ptr<Counters>> m_windows;
+
+    const std::shared_ptr<Counters> m_unassigned = std::make_shared<Counters>();
+    Counters m_total;
+
+    std::atomic<qsizetype> m_sharedGeometryBytes {0};
+    std::atomic<qsizetype> m_budget {0};
+};
+
+// Radii and segment counts of the corners of a shape, in the
+// order they appear in the outline: top left, top right, bottom
+// right and bottom left.
+struct Corners
+{
+    std::array<qreal, 4> radii;
+    std::array<int, 4> segmentCounts;
+
+    // When every corner is fully rounded, the shape is a circle
+    // or a stadium, and its outline is generated as a whole
+    // rather than corner by corner. This is then the number of
+    // segments of all of its arcs together, otherwise it is 0.
+    int fullyRoundedSegmentCount = 0;
+    bool circle = false;
+
+    Corners(const QSGRoundedRectangularImageNode::Shape& shape,
+            const QSGRoundedRectangularImageNode::Tessellation& tessellation)
+    {
+        assert(shape.isValid() && tessellation.isValid());
+
+        static constexpr Qt::Corner order[] = {Qt::TopLeftCorner,
+                                               Qt::TopRightCorner,
+                                               Qt::BottomRightCorner,
+                                               Qt::BottomLeftCorner};
+
+        // Same as what QPainterPath does with a single radius,
+        // adjacent corners never overlap this way:
+        const qreal maximumRadius = std::min(shape.rect.width(), shape.rect.height()) / 2;
+
+        for (int i = 0; i < 4; ++i)
+        {
+            radii[i] = std::min(shape.cornerRadius(order[i]), maximumRadius);
+
+            // Corners without radius consist of a single point
+            segmentCounts[i] = qFuzzyIsNull(radii[i]) ? 0 : tessellation.cornerSegmentCount(radii[i]);
+        }
+
+        const bool fullyRounded = std::all_of(radii.cbegin(), radii.cend(), [maximumRadius](const qreal radius) {
+            return qFuzzyCompare(radius, maximumRadius);
+        });
+
+        if (fullyRounded)
+        {
+            circle = qFuzzyCompare(shape.rect.width(), shape.rect.height());
+
+            // Same minimums as with the corners, but the whole turn
+            // is divided at once, so no more segments than needed
+            // are spent on each quarter of it:
+            if (circle)
+            {
+                fullyRoundedSegmentCount = arcSegmentCount(tessellation,
+                                                           maximumRadius,
+                                                           2.0 * M_PI,
+                                                           4,
+                                                           4 * maximumCornerSegmentCount);
+            }
+            else
+            {
+                fullyRoundedSegmentCount = 2 * arcSegmentCount(tessellation,
+                                                               maximumRadius,
+                                                               M_PI,
+                                                               2,
+                                                               2 * maximumCornerSegmentCount);
+            }
+        }
+    }
+
+    bool isFullyRounded() const
+    {
+        return fullyRoundedSegmentCount > 0;
+    }
+
+    bool isRectangular() const
+    {
+        return std::all_of(segmentCounts.cbegin(), segmentCounts.cend(), [](const int segmentCount) {
+            return segmentCount == 0;
+        });
+    }
+
+    int vertexCount() const
+    {
+        // Corners meet each other without any straight edge
+        // in between, so their shared points are not repeated:
+        if (isFullyRounded())
+            return circle ? fullyRoundedSegmentCount : fullyRoundedSegmentCount + 2;
+
+        int count = 0;
+        for (const int segmentCount : segmentCounts)
+            count += segmentCount + 1;
+        return count;
+    }
+};
+
+// Keeps track of the geometries shared by the nodes that have
+// geometry sharing enabled. Geometries are owned by the nodes
+// using them, and they unregister themselves once the last node
+// releases them.
+class SharedGeometryRegistry
+{
+public:
+    static std::shared_ptr<QSGGeometry> geometry(const QSGRoundedRectangularImageNode::Shape& shape,
+                                                 const QSGRoundedRectangularImageNode::Tessellation& tessellation,
+                                                 const QSGRoundedRectangularImageNode::Topology topology)
+    {
+        assert(shape.isValid());
+
+        const Corners corners(shape, tessellation);
+        const Key key {shape.rect.size(),
+                       corners.radii,
+                       corners.segmentCounts,
+                       corners.fullyRoundedSegmentCount,
+                       topology};
+
+        static SharedGeometryRegistry registry;
+
+        const QMutexLocker locker(&registry.m_mutex);
+
+        std::weak_ptr<QSGGeometry>& entry = registry.m_geometries[key];
+        if (std::shared_ptr<QSGGeometry> geometry = entry.lock())
+            return geometry;
+
+        QSGRoundedRectangularImageNode::Shape normalizedShape = shape;
+        normalizedShape.rect.moveTopLeft({});
+
+        QSGGeometry* const geometry = QSGRoundedRectangularImageNode::rebuildGeometry(normalizedShape,
+                                                                                      nullptr,
+                                                                                      nullptr,
+                                                                                      tessellation,
+                                                                                      topology);
+        assert(geometry);
+
+        const qsizetype size = geometrySize(*geometry);
+        MemoryAccounting::instance().updateSharedGeometry(size);
+
+        std::shared_ptr<QSGGeometry> sharedGeometry(geometry, [key, size](QSGGeometry* const geometry) {
+            MemoryAccounting::instance().updateSharedGeometry(-size);
+
+            {
+                const QMutexLocker locker(&registry.m_mutex);
+
+                // Another node might have registered a
+                // new geometry for the same key meanwhile
+                const auto it = registry.m_geometries.find(key);
+                if (it != registry.m_geometries.end() && it->expired())
+                    registry.m_geometries.erase(it);
+            }
+
+            delete geometry;
+        });
+
+        entry = sharedGeometry;
+        return sharedGeometry;
+    }
+
+private:
+    struct Key
+    {
+        QSizeF size;
+        std::array<qreal, 4> radii;
+        std::array<int, 4> segmentCounts;
+        int fullyRoundedSegmentCount;
+        QSGRoundedRectangularImageNode::Topology topology;
+
+        bool operator ==(const Key& b) const
+        {
+            return (size == b.size &&
+                    radii == b.radii &&
+                    segmentCounts == b.segmentCounts &&
+                    fullyRoundedSegmentCount == b.fullyRoundedSegmentCount &&
+                    topology == b.topology);
+        }
+
+        friend size_t qHash(const Key& key, const size_t seed = 0)
+        {
+            return qHashMulti(seed,
+                              key.size.width(), key.size.height(),
+                              key.radii[0], key.radii[1], key.radii[2], key.radii[3],
+                              key.segmentCounts[0], key.segmentCounts[1], key.segmentCounts[2], key.segmentCounts[3],
+                              key.fullyRoundedSegmentCount,
+                              static_cast<int>(key.topology));
+        }
+    };
+
+    QMutex m_mutex;
+    QHash<Key, std::weak_ptr<QSGGeometry>> m_geometries;
+};
+
+// Outline of a circle or a stadium, in the same direction as the
+// outline of the other shapes. It is computed directly instead of
+// being derived from the unit arcs: the arcs span the whole turn
+// or its halves, so they would not be of use to any other shape.
+void fillFullyRoundedOutline(float* const x, float* const y, const QRectF& rect, const Corners& corners)
+{
+    assert(corners.isFullyRounded());
+
+    QSGROUNDEDRECTANGULARIMAGENODE_ZONE("RoundedRectangularImage outline");
+
+    const qreal radius = corners.radii[0];
+    const QPointF center = rect.center();
+
+    if (corners.circle)
+    {
+        const int count = corners.fullyRoundedSegmentCount;
+        const qreal step = (2.0 * M_PI) / count;
+
+        // Starts at the left, as the top left corner does
+        for (int i = 0; i < count; ++i)
+        {
+            const qreal angle = M_PI + (step * i);
+            x[i] = center.x() + (radius * std::cos(angle));
+            y[i] = center.y() + (radius * std::sin(angle));
+        }
+
+        return;
+    }
+
+    // Two half circles, the second one is the first one
+    // rotated by 180 degrees around the center
+    const int halfSegmentCount = corners.fullyRoundedSegmentCount / 2;
+    const qreal step = M_PI / halfSegmentCount;
+
+    const bool horizontal = rect.width() > rect.height();
+    const QPointF offset = horizontal ? QPointF((rect.width() / 2) - radius, 0.0)
+                                      : QPointF(0.0, (rect.height() / 2) - radius);
+    const QPointF first = center - offset;
+    const QPointF second = center + offset;
+    const qreal startAngle = horizontal ? M_PI_2 : M_PI;
+
+    for (int i = 0; i <= halfSegmentCount; ++i)
+    {
+        const qreal angle = startAngle + (step * i);
+        const qreal dx = radius * std::cos(angle);
+        const qreal dy = radius * std::sin(angle);
+
+        x[i] = first.x() + dx;
+        y[i] = first.y() + dy;
+        x[i + halfSegmentCount + 1] = second.x() - dx;
+        y[i + halfSegmentCount + 1] = second.y() - dy;
+    }
+}
+
+// Fills the outline of a rounded rectangle directly in triangle
+// strip order. The outline is the same as of
+// `QPainterPath::addRoundedRect()`: it starts at the left end of
+// the top left corner, and goes clockwise. As the outline is convex,
+// it is triangulated by zigzagging between its two ends: the strip
+// goes as `0, 1, count - 1, 2, count - 2, ...`. Unlike the symmetry
+// based triangulation once used on the simplified QPainterPath, this
+// covers the outline exactly even when some corners are sharp.
+void fillRoundedRect(QSGGeometry::TexturedPoint2D* const points,
+                     const QRectF& rect,
+                     const Corners& corners,
+                     const QRectF& texNormalSubRect,
+                     const QSGRoundedRectangularImageNode::Topology topology)
+{
+    const int count = corners.vertexCount();
+
+    // The outline is first built in structure of arrays
+    // form, in outline order, which keeps the loops below
+    // free of scattered stores so that they can be vectorized
+    using Buffer = QVarLengthArray<float, 4 * (maximumCornerSegmentCount + 1)>;
+    Buffer x(count);
+    Buffer y(count);
+
+    if (corners.isFullyRounded())
+    {
+        fillFullyRoundedOutline(x.data(), y.data(), rect, corners);
+    }
+    else
+    {
+        QSGROUNDEDRECTANGULARIMAGENODE_ZONE("RoundedRectangularImage outline");
+
+        // Point `i` of a corner is at
+        // `center + m * (cos, sin)`, where `m`
+        // is rotation scaled by the radius:
+        struct Corner
+        {
+            float cx, cy;
+            float m11, m12, m21, m22;
+        };
+
+        const std::array<qreal, 4>& r = corners.radii;
+        const Corner cornerArray[] = {
+            {float(rect.left() + r[0]), float(rect.top() + r[0]), float(-r[0]), 0.f, 0.f, float(-r[0])}, // top left
+            {float(rect.right() - r[1]), float(rect.top() + r[1]), 0.f, float(r[1]), float(-r[1]), 0.f}, // top right
+            {float(rect.right() - r[2]), float(rect.bottom() - r[2]), float(r[2]), 0.f, 0.f, float(r[2])}, // bottom right
+            {float(rect.left() + r[3]), float(rect.bottom() - r[3]), 0.f, float(-r[3]), float(r[3]), 0.f} // bottom left
+        };
+
+        SharedUnitCornerArc arc;
+
+        int offset = 0;
+        for (int k = 0; k < 4; ++k)
+        {
+            const Corner& corner = cornerArray[k];
+            const int segmentCount = corners.segmentCounts[k];
+
+            if (segmentCount == 0)
+            {
+                x[offset] = corner.cx;
+                y[offset] = corner.cy;
+                ++offset;
+                continue;
+            }
+
+            const int n = segmentCount + 1;
+            const float* c;
+            const float* s;
+
+            if (segmentCount <= constexprCornerSegmentCount)
+            {
+                c = unitCornerArcTable.cos.data() + unitCornerArcTable.offsets[segmentCount];
+                s = unitCornerArcTable.sin.data() + unitCornerArcTable.offsets[segmentCount];
+            }
+            else
+            {
+                // Adjacent corners often have the same segment count
+                if (!arc || arc->count() != n)
+                    arc = UnitCornerArcCache::instance().arc(segmentCount);
+
+                c = arc->cos();
+                s = arc->sin();
+            }
+
+            float* const px = x.data() + offset;
+            float* const py = y.data() + offset;
+
+            for (int i = 0; i < n; ++i)
+            {
+                px[i] = corner.cx + (corner.m11 * c[i]) + (corner.m12 * s[i]);
+                py[i] = corner.cy + (corner.m21 * c[i]) + (corner.m22 * s[i]);
+            }
+
+            offset += n;
+        }
+
+        assert(offset == count);
+    }
+
+    QSGROUNDEDRECTANGULARIMAGENODE_ZONE("RoundedRectangularImage vertex fill");
+
+    // Texture coordinates are derived from the positions,
+    // with multiplication instead of division:
+    const float rx = rect.x();
+    const float ry = rect.y();
+    const float tx = texNormalSubRect.x();
+    const float ty = texNormalSubRect.y();
+    const float tsx = texNormalSubRect.width() / rect.width();
+    const float tsy = texNormalSubRect.height() / rect.height();
+
+    Buffer u(count);
+    Buffer v(count);
+    for (int i = 0; i < count; ++i)
+    {
+        u[i] = tx + (x[i] - rx) * tsx;
+        v[i] = ty + (y[i] - ry) * tsy;
+    }
+
+    const auto store = [&](const int j, const int i) {
+        points[j].set(x[i], y[i], u[i], v[i]);
+    };
+
+    if (topology == QSGRoundedRectangularImageNode::Topology::IndexedTriangles)
+    {
+        // Center of the fan, followed by the outline:
+        const QPointF center = rect.center();
+        points[0].set(center.x(), center.y(), tx + (center.x() - rx) * tsx, ty + (center.y() - ry) * tsy);
+
+        for (int i = 0; i < count; ++i)
+            store(i + 1, i);
+    }
+    else
+    {
+        // Zigzag between the two ends of the outline:
+        store(0, 0);
+        for (int k = 1; (2 * k) - 1 < count; ++k)
+        {
+            store((2 * k) - 1, k);
+            if (2 * k < count)
+                store(2 * k, count - k);
+        }
+    }
+}
+
+// Triangles of a fan around the first vertex,
+// with the outline following it
+void fillFanIndices(quint16* const indices, const int outlineCount)
+{
+    for (int i = 0; i < outlineCount; ++i)
+    {
+        indices[(3 * i)] = 0;
+        indices[(3 * i) + 1] = i + 1;
+        indices[(3 * i) + 2] = ((i + 1) % outlineCount) + 1;
+    }
+}
+
+// At most this many times the needed amount of
+// vertices (or indices) is kept in a reused geometry
+constexpr int maximumPaddingRatio = 4;
+
+// Turns the vertices (and indices) of the geometry following the
+// first `vertexCount` (and `indexCount`) into degenerate triangles
+void padGeometry(QSGGeometry* const geometry, const int vertexCount, const int indexCount)
+{
+    assert(vertexCount > 0);
+    assert(geometry->vertexCount() >= vertexCount && geometry->indexCount() >= indexCount);
+
+    QSGGeometry::TexturedPoint2D* const points = geometry->vertexDataAsTexturedPoint2D();
+
+    if (geometry->indexCount() > 0)
+    {
+        // Triangles referring to the first vertex only. The padding
+        // vertices are not referred to, but they are still kept
+        // within the shape:
+        quint16* const indices = geometry->indexDataAsUShort();
+        std::fill(indices + indexCount, indices + geometry->indexCount(), 0);
+        std::fill(points + vertexCount, points + geometry->vertexCount(), points[0]);
+    }
+    else
+    {
+        // Repeating the last vertex of a strip adds zero area triangles
+        std::fill(points + vertexCount, points + geometry->vertexCount(), points[vertexCount - 1]);
+    }
+}
+
+constexpr QSGGeometry::DrawingMode drawingMode(const QSGRoundedRectangularImageNode::Topology topology)
+{
+    return (topology == QSGRoundedRectangularImageNode::Topology::IndexedTriangles)
+               ? QSGGeometry::DrawingMode::DrawTriangles
+               : QSGGeometry::DrawingMode::DrawTriangleStrip;
+}
+
+}
+
+void QSGRoundedRectangularImageNode::setPathCacheCapacity(const qsizetype bytes)
+{
+    UnitCornerArcCache::instance().setCapacity(bytes);
+}
+
+void QSGRoundedRectangularImageNode::prewarmPathCache(const QVector<Shape>& shapes, const Tessellation& tessellation)
+{
+    assert(tessellation.isValid());
+
+    std::array<bool, maximumCornerSegmentCount + 1> segmentCounts {};
+
+    for (const Shape& shape : shapes)
+    {
+        if (!shape.isValid())
+            continue;
+
+        const Corners corners(shape, tessellation);
+
+        // Circles and stadiums do not use the cache
+        if (corners.isFullyRounded())
+            continue;
+
+        for (const int segmentCount : corners.segmentCounts)
+            segmentCounts[segmentCount] = true;
+    }
+
+    // Sharp corners do not need an arc, and
+    // neither do the arcs built at compile time
+    for (int i = constexprCornerSegmentCount + 1; i <= maximumCornerSegmentCount; ++i)
+    {
+        if (segmentCounts[i])
+            UnitCornerArcCache::instance().prewarm(i);
+    }
+}
+
+QSGRoundedRectangularImageNode::MemoryStatistics QSGRoundedRectangularImageNode::memoryStatistics()
+{
+    return MemoryAccounting::instance().statistics();
+}
+
+QSGRoundedRectangularImageNode::MemoryStatistics QSGRoundedRectangularImageNode::memoryStatistics(const QQuickWindow* const window)
+{
+    return MemoryAccounting::instance().statistics(window);
+}
+
+void QSGRoundedRectangularImageNode::setMemoryBudget(const qsizetype bytes)
+{
+    MemoryAccounting::instance().setBudget(bytes);
+}
+
+qsizetype QSGRoundedRectangularImageNode::memoryBudget()
+{
+    return MemoryAccounting::instance().budget();
+}
+
+qsizetype QSGRoundedRectangularImageNode::pathCacheCapacity()
+{
+    return UnitCornerArcCache::instance().capacity();
+}
+
+QSGRoundedRectangularImageNode::PathCacheStatistics QSGRoundedRectangularImageNode::pathCacheStatistics()
+{
+    return UnitCornerArcCache::instance().statistics();
+}
+
+QSGRoundedRectangularImageNode::GeometryStatistics QSGRoundedRectangularImageNode::geometryStatistics()
+{
+    GeometryStatistics statistics;
+    statistics.rebuilds = geometryCounters.rebuilds.load(std::memory_order_relaxed);
+    statistics.vertices = geometryCounters.vertices.load(std::memory_order_relaxed);
+    statistics.allocations = geometryCounters.allocations.load(std::memory_order_relaxed);
+    return statistics;
+}
+
+int QSGRoundedRectangularImageNode::Tessellation::cornerSegmentCount(const qreal radius) const
+{
+    return arcSegmentCount(*this, radius, M_PI_2, 1, maximumCornerSegmentCount);
+}
+
+int QSGRoundedRectangularImageNode::vertexCount(const Shape& shape, const Tessellation& tessellation)
+{
+    assert(shape.isValid() && tessellation.isValid());
+
+    const Corners corners(shape, tessellation);
+    if (corners.isRectangular())
+        return 4;
+
+    return corners.vertexCount();
+}
+
+void QSGRoundedRectangularImageNode::fillVertices(QSGGeometry::TexturedPoint2D* const points,
+                                                  const Shape& shape,
+                                                  const QRectF& texNormalSubRect,
+                                                  const Tessellation& tessellation)
+{
+    assert(points);
+    assert(shape.isValid() && tessellation.isValid());
+
+    const Corners corners(shape, tessellation);
+    if (corners.isRectangular())
+    {
+        // Same as what QSGGeometry::updateTexturedRectGeometry() does:
+        const QRectF& rect = shape.rect;
+        points[0].set(rect.left(), rect.top(), texNormalSubRect.left(), texNormalSubRect.top());
+        points[1].set(rect.left(), rect.bottom(), texNormalSubRect.left(), texNormalSubRect.bottom());
+        points[2].set(rect.right(), rect.top(), texNormalSubRect.right(), texNormalSubRect.top());
+        points[3].set(rect.right(), rect.bottom(), texNormalSubRect.right(), texNormalSubRect.bottom());
+    }
+    else
+    {
+        fillRoundedRect(points, shape.rect, corners, texNormalSubRect, Topology::TriangleStrip);
+    }
+}
+
+QSGRoundedRectangularImageNode::QSGRoundedRectangularImageNode()
+{
+    setFlags(QSGGeometryNode::OwnsMaterial |
+             QSGGeometryNode::OwnsOpaqueMaterial |
+             QSGGeometryNode::OwnsGeometry);
+
+    setMaterial(new QSGTextureMaterial);
+    setOpaqueMaterial(new QSGOpaqueTextureMaterial);
+
+    applyFiltering();
+
+    m_memoryCounters = MemoryAccounting::instance().counters(m_accountingWindow);
+    MemoryAccounting::instance().update(*m_memoryCounters, 0, 0, 1);
+    updateMemoryAccounting();
+
+     // Useful for debugging:
+#ifdef QSG_RUNTIME_DESCRIPTION
+    qsgnode_set_description(this, QStringLiteral("RoundedRectangularImage"));
+#endif
+}
+
+QSGRoundedRectangularImageNode::~QSGRoundedRectangularImageNode()
+{
+    MemoryAccounting::instance().update(*m_memoryCounters,
+                                        -m_accountedGeometryBytes,
+                                        -m_accountedMaterialBytes,
+                                        -1);
+}
+
+void QSGRoundedRectangularImageNode::setAccountingWindow(const QQuickWindow* const window)
+{
+    if (m_accountingWindow == window)
+        return;
+
+    MemoryAccounting& accounting = MemoryAccounting::instance();
+    accounting.update(*m_memoryCounters, -m_accountedGeometryBytes, -m_accountedMaterialBytes, -1);
+
+    m_accountingWindow = window;
+    m_memoryCounters = accounting.counters(window);
+
+    accounting.update(*m_memoryCounters, m_accountedGeometryBytes, m_accountedMaterialBytes, 1);
+}
+
+void QSGRoundedRectangularImageNode::setBudgetFallback(const BudgetFallback fallback)
+{
+    if (m_budgetFallback == fallback)
+        return;
+
+    m_budgetFallback = fallback;
+
+    enforceMemoryBudget();
+}
+
+void QSGRoundedRectangularImageNode::updateMemoryAccounting()
+{
+    // Shared geometry is accounted separately
+    const qsizetype geometryBytes = (m_sharedGeometry || !geometry()) ? 0 : geometrySize(*geometry());
+
+    const qsizetype materialBytes = (m_mode == Mode::DistanceField)
+                                        ? sizeof(QSGRoundedRectangularImageMaterial)
+                                        : (sizeof(QSGTextureMaterial) + sizeof(QSGOpaqueTextureMaterial));
+
+    if (geometryBytes == m_accountedGeometryBytes && materialBytes == m_accountedMaterialBytes)
+        return;
+
+    MemoryAccounting::instance().update(*m_memoryCounters,
+                                        geometryBytes - m_accountedGeometryBytes,
+                                        materialBytes - m_accountedMaterialBytes,
+                                        0);
+
+    m_accountedGeometryBytes = geometryBytes;
+    m_accountedMaterialBytes = materialBytes;
+}
+
+void QSGRoundedRectangularImageNode::enforceMemoryBudget()
+{
+    const MemoryAccounting& accounting = MemoryAccounting::instance();
+
+    qsizetype excess = accounting.excess();
+    if (excess <= 0)
+        return;
+
+    // The cache is the cheapest to give up, only
+    // costing arcs to be built again as needed. Its
+    // capacity stays, so it fills up again once the
+    // usage is back under the budget.
+    //
+    // It is not trimmed below its share of the budget
+    // though: evicting wipes the local tiers of all the
+    // render threads, so trimming on every update, when
+    // the rest of the excess is not the cache's, would
+    // have them miss and contend on the shared tier.
+    UnitCornerArcCache& cache = UnitCornerArcCache::instance();
+    const qsizetype share = accounting.budget() / pathCacheBudgetDivisor;
+    const qsizetype residentBytes = cache.residentBytes();
+    if (residentBytes > share)
+    {
+        cache.trim(std::max(share, residentBytes - excess));
+
+        excess = accounting.excess();
+        if (excess <= 0)
+            return;
+    }
+
+    switch (m_budgetFallback)
+    {
+    case BudgetFallback::SharedGeometry:
+        setGeometrySharing(true);
+        break;
+    case BudgetFallback::DistanceField:
+        setMode(Mode::DistanceField);
+        break;
+    case BudgetFallback::None:
+        break;
+    }
+}
+
+QSGTextureMaterial *QSGRoundedRectangularImageNode::material() const
+{
+    assert(m_mode == Mode::Tessellated);
+    return material_cast<QSGTextureMaterial*>(QSGGeometryNode::material());
+}
+
+QSGOpaqueTextureMaterial *QSGRoundedRectangularImageNode::opaqueMaterial() const
+{
+    assert(m_mode == Mode::Tessellated);
+    return material_cast<QSGOpaqueTextureMaterial*>(QSGGeometryNode::opaqueMaterial());
+}
+
+QSGRoundedRectangularImageMaterial *QSGRoundedRectangularImageNode::distanceFieldMaterial() const
+{
+    assert(m_mode == Mode::DistanceField);
+    return material_cast<QSGRoundedRectangularImageMaterial*>(QSGGeometryNode::material());
+}
+
+void QSGRoundedRectangularImageNode::setSmooth(const bool smooth)
+{
+    if (m_smooth == smooth)
+        return;
+
+    m_smooth = smooth;
+
+    applyFiltering();
+
+    markDirty(QSGNode::DirtyMaterial);
+}
+
+qreal QSGRoundedRectangularImageNode::minification(const QSGTexture& texture,
+                                                   const QRectF& texNormalSubRect,
+                                                   const QSizeF& targetSize)
+{
+    // Size of the whole texture, also for parts of an atlas
+    const QRectF textureSubRect = texture.normalizedTextureSubRect();
+    const QSize textureSize = texture.textureSize();
+
+    const qreal sourceWidth = texNormalSubRect.width() * textureSize.width() / textureSubRect.width();
+    const qreal sourceHeight = texNormalSubRect.height() * textureSize.height() / textureSubRect.height();
+
+    return std::max(sourceWidth / targetSize.width(), sourceHeight / targetSize.height());
+}
+
+QSGTexture::Filtering QSGRoundedRectangularImageNode::mipmapFiltering(const QSGTexture& texture,
+                                                                      const qreal minification,
+                                                                      const bool smooth,
+                                                                      const qreal threshold)
+{
+    // Mipmaps only pay off when the texture is minified enough,
+    // otherwise linear filtering alone gives the same result
+    // without the memory bandwidth:
+    if (!smooth || !(minification >= threshold))
+        return QSGTexture::None;
+
+    // Plain textures generate their mipmaps once mipmap
+    // filtering is set on them, but parts of an atlas can not
+    if (texture.isAtlasTexture() && !texture.hasMipmaps())
+        return QSGTexture::None;
+
+    return QSGTexture::Linear;
+}
+
+bool QSGRoundedRectangularImageNode::applyFiltering()
+{
+    const enum QSGTexture::Filtering filtering = m_smooth ? QSGTexture::Linear : QSGTexture::Nearest;
+    enum QSGTexture::Filtering mipmapFiltering = QSGTexture::None;
+
+    bool requestMipmaps = false;
+
+    const Shape shape = this->shape();
+    if (m_smooth && m_texture && shape.isValid())
+    {
+        const qreal minification = QSGRoundedRectangularImageNode::minification(*m_texture,
+                                                                                m_texture->normalizedTextureSubRect(),
+                                                                                shape.rect.size() * m_tessellation.devicePixelRatio);
+
+        mipmapFiltering = QSGRoundedRectangularImageNode::mipmapFiltering(*m_texture, minification, m_smooth, m_mipmapThreshold);
+
+        // Atlas textures that should be mipmapped,
+        // but can not be, are asked from the handler
+        if (mipmapFiltering == QSGTexture::None && minification >= m_mipmapThreshold)
+            requestMipmaps = (m_mipmapRequestHandler && !m_mipmapsRequested && !m_requestingMipmaps);
+    }
+
+    bool changed;
+
+    if (m_mode == Mode::DistanceField)
+    {
+        QSGRoundedRectangularImageMaterial* const material = distanceFieldMaterial();
+        changed = (material->filtering() != filtering || material->mipmapFiltering() != mipmapFiltering);
+
+        material->setFiltering(filtering);
+        material->setMipmapFiltering(mipmapFiltering);
+    }
+    else
+    {
+        changed = (material()->filtering() != filtering || material()->mipmapFiltering() != mipmapFiltering);
+
+        material()->setFiltering(filtering);
+        opaqueMaterial()->setFiltering(filtering);
+
+        material()->setMipmapFiltering(mipmapFiltering);
+        opaqueMaterial()->setMipmapFiltering(mipmapFiltering);
+    }
+
+    // Done last, as the handler may set the new texture right away
+    if (requestMipmaps)
+    {
+        m_mipmapsRequested = true;
+
+        // Textures set by the handler while it runs are its
+        // answer, and are not asked about again. The handler
+        // gets its own reference, which stays valid when it
+        // replaces the texture of the node.
+        const std::shared_ptr<QSGTexture> texture = m_texture;
+
+        m_requestingMipmaps = true;
+        m_mipmapRequestHandler(texture);
+        m_requestingMipmaps = false;
+    }
+
+    return changed;
+}
+
+void QSGRoundedRectangularImageNode::setMipmapThreshold(const qreal threshold)
+{
+    if (qFuzzyCompare(m_mipmapThreshold, threshold))
+        return;
+
+    m_mipmapThreshold = threshold;
+
+    if (applyFiltering())
+        markDirty(QSGNode::DirtyMaterial);
+}
+
+void QSGRoundedRectangularImageNode::setMipmapRequestHandler(const MipmapRequestHandler& handler)
+{
+    m_mipmapRequestHandler = handler;
+    m_mipmapsRequested = false;
+
+    if (applyFiltering())
+        markDirty(QSGNode::DirtyMaterial);
+}
+
+void QSGRoundedRectangularImageNode::applyTexture()
+{
+    if (m_mode == Mode::DistanceField)
+    {
+        distanceFieldMaterial()->setTexture(m_texture.get());
+    }
+    else
+    {
+        material()->setTexture(m_texture.get());
+        opaqueMaterial()->setTexture(m_texture.get());
+    }
+}
+
+void QSGRoundedRectangularImageNode::setTexture(const std::shared_ptr<QSGTexture>& texture)
+{
+    assert(texture);
+
+    {
+        const bool hadTexture = static_cast<bool>(m_texture);
+        const bool wasAtlas = (!m_texture || m_texture->isAtlasTexture());
+
+        if (texture != m_texture)
+            m_mipmapsRequested = m_requestingMipmaps;
+
+        m_texture = texture;
+
+        // Unless we operate on atlas textures, it should be
+        // fine to not rebuild the geometry
+        if ((wasAtlas || texture->isAtlasTexture()) && !deferUpdate(PendingTextureCoordinates))
+        {
+            // Texture coordinate mismatch
+            if (!hadTexture && m_pendingUpdates != 0)
+            {
+                // Catch up with the changes made without a texture
+                m_pendingUpdates |= PendingTextureCoordinates;
+                commit();
+            }
+            else if (m_geometrySharing || !m_shape.isValid())
+                rebuildGeometry(); // Might need to switch between shared and own geometry
+            else
+                updateTextureCoordinates(); // Positions are still valid
+        }
+    }
+
+    applyTexture();
+    applyFiltering();
+
+    markDirty(QSGNode::DirtyMaterial);
+}
+
+void QSGRoundedRectangularImageNode::setMode(const Mode mode)
 {
-#ifdef NDEBUG
-    return static_cast<T>(object);
-#else
-    const auto ret = dynamic_cast<T>(material);
-    assert(ret); // incompatible material type
-    return ret;
-#endif
+    if (m_mode == mode)
+        return;
+
+    m_mode = mode;
+
+    // Old materials are deleted, as they are owned:
+    if (mode == Mode::DistanceField)
+    {
+        setMaterial(new QSGRoundedRectangularImageMaterial);
+        setOpaqueMaterial(nullptr); // Corners are always blended
+    }
+    else
+    {
+        setMaterial(new QSGTextureMaterial);
+        setOpaqueMaterial(new QSGOpaqueTextureMaterial);
+    }
+
+    applyFiltering();
+    applyTexture();
+
+    markDirty(QSGNode::DirtyMaterial);
+
+    updateMemoryAccounting();
+
+    if (m_shape.isValid() && !deferUpdate(PendingRebuild))
+        rebuildGeometry();
 }
 
-QSGRoundedRectangularImageNode::QSGRoundedRectangularImageNode()
+bool QSGRoundedRectangularImageNode::setShape(const Shape& shape)
 {
-    setFlags(QSGGeometryNode::OwnsMaterial |
-             QSGGeometryNode::OwnsOpaqueMaterial |
-             QSGGeometryNode::OwnsGeometry);
+    if (this->shape() == shape)
+        return false;
 
-    setMaterial(new QSGTextureMaterial);
-    setOpaqueMaterial(new QSGOpaqueTextureMaterial);
+    // Nodes without a texture have nothing to draw,
+    // the shape is built once there is a texture
+    if (updatesDeferred() || !m_texture)
+    {
+        if (!shape.isValid())
+            return false;
 
-    setSmooth(m_smooth);
+        m_pendingShape = shape;
+        m_pendingUpdates |= PendingShape;
+    }
+    else if (!applyShape(shape))
+    {
+        return false;
+    }
 
-     // Useful for debugging:
-#ifdef QSG_RUNTIME_DESCRIPTION
-    qsgnode_set_description(this, QStringLiteral("RoundedRectangularImage"));
-#endif
+    // Minification depends on the size
+    if (applyFiltering())
+        markDirty(QSGNode::DirtyMaterial);
+
+    enforceMemoryBudget();
+
+    return true;
 }
 
-QSGTextureMaterial *QSGRoundedRectangularImageNode::material() const
+bool QSGRoundedRectangularImageNode::isTranslation(const Shape& shape) const
 {
-    return material_cast<QSGTextureMaterial*>(QSGGeometryNode::material());
+    return (m_shape.isValid() &&
+            shape.isValid() &&
+            shape.rect.size() == m_shape.rect.size() &&
+            (m_mode == Mode::DistanceField || shape.hasSameRadii(m_shape)));
 }
 
-QSGOpaqueTextureMaterial *QSGRoundedRectangularImageNode::opaqueMaterial() const
+bool QSGRoundedRectangularImageNode::applyShape(const Shape& shape)
 {
-    return material_cast<QSGOpaqueTextureMaterial*>(QSGGeometryNode::opaqueMaterial());
+    if (m_shape == shape)
+        return false;
+
+    if (isTranslation(shape))
+    {
+        // Only the position, or the radii which are
+        // not part of the geometry, have changed
+        translateGeometry(shape.rect.topLeft() - m_shape.rect.topLeft());
+
+        if (m_mode == Mode::DistanceField)
+            updateDistanceFieldMaterial(shape);
+
+        m_shape = shape;
+        return true;
+    }
+
+    startCoarsePhase();
+
+    const bool ret = rebuildGeometry(shape);
+
+    if (ret)
+        m_shape = shape;
+
+    return ret;
 }
 
-void QSGRoundedRectangularImageNode::setSmooth(const bool smooth)
+void QSGRoundedRectangularImageNode::translateGeometry(const QPointF& delta)
 {
-    if (m_smooth == smooth)
+    // Shared geometry is positioned by a transform
+    // node, and it must not be modified anyway. So
+    // is own geometry while sharing is enabled.
+    if (m_sharedGeometry || m_geometrySharing || delta.isNull())
         return;
 
+    QSGGeometry* const geometry = this->geometry();
+    assert(geometry);
+
+    // Texture coordinates are relative to
+    // the shape, so they are left as they are
+    QSGGeometry::TexturedPoint2D* const points = geometry->vertexDataAsTexturedPoint2D();
+
+    const float dx = delta.x();
+    const float dy = delta.y();
+    for (int i = 0; i < geometry->vertexCount(); ++i)
     {
-        const enum QSGTexture::Filtering filtering = smooth ? QSGTexture::Linear : QSGTexture::Nearest;
-        material()->setFiltering(filtering);
-        opaqueMaterial()->setFiltering(filtering);
+        points[i].x += dx;
+        points[i].y += dy;
     }
 
+    geometry->markVertexDataDirty();
+    markDirty(QSGNode::DirtyGeometry);
+}
+
+void QSGRoundedRectangularImageNode::updateTextureCoordinates()
+{
+    assert(!m_sharedGeometry);
+    assert(m_shape.isValid());
+
+    QSGGeometry* const geometry = this->geometry();
+    assert(geometry);
+
+    const QRectF texNormalSubRect = m_texture->isAtlasTexture() ? m_texture->normalizedTextureSubRect()
+                                                                : QRectF {0.0, 0.0, 1.0, 1.0};
+
+    // Derive the texture coordinates from the positions,
+    // the same way they are derived when the geometry is
+    // built:
+    const QPointF position = m_geometrySharing ? QPointF() : m_shape.rect.topLeft();
+    const float x = position.x();
+    const float y = position.y();
+    const float tx = texNormalSubRect.x();
+    const float ty = texNormalSubRect.y();
+    const float tsx = texNormalSubRect.width() / m_shape.rect.width();
+    const float tsy = texNormalSubRect.height() / m_shape.rect.height();
+
+    QSGGeometry::TexturedPoint2D* const points = geometry->vertexDataAsTexturedPoint2D();
+    for (int i = 0; i < geometry->vertexCount(); ++i)
     {
-        const enum QSGTexture::Filtering mipmapFiltering = smooth ? QSGTexture::Linear : QSGTexture::None;
-        material()->setMipmapFiltering(mipmapFiltering);
-        opaqueMaterial()->setMipmapFiltering(mipmapFiltering);
+        points[i].tx = tx + (points[i].x - x) * tsx;
+        points[i].ty = ty + (points[i].y - y) * tsy;
     }
 
+    geometry->markVertexDataDirty();
+    markDirty(QSGNode::DirtyGeometry);
+}
+
+void QSGRoundedRectangularImageNode::updateDistanceFieldMaterial(const Shape& shape)
+{
+    // Geometry is placed at the origin while sharing
+    distanceFieldMaterial()->setShape((m_sharedGeometry || m_geometrySharing) ? QRectF(QPointF(), shape.rect.size()) : shape.rect,
+                                      {shape.cornerRadius(Qt::TopLeftCorner),
+                                       shape.cornerRadius(Qt::TopRightCorner),
+                                       shape.cornerRadius(Qt::BottomRightCorner),
+                                       shape.cornerRadius(Qt::BottomLeftCorner)});
+
     markDirty(QSGNode::DirtyMaterial);
 }
 
-void QSGRoundedRectangularImageNode::setTexture(const std::shared_ptr<QSGTexture>& texture)
+bool QSGRoundedRectangularImageNode::setTessellation(const Tessellation& tessellation)
 {
-    assert(texture);
+    if (!tessellation.isValid())
+        return false;
+
+    if (m_tessellation == tessellation)
+        return false;
+
+    m_tessellation = tessellation;
 
+    // Minification depends on the device pixel ratio
+    if (applyFiltering())
+        markDirty(QSGNode::DirtyMaterial);
+
+    // Rectangle without rounded corners is not tessellated,
+    // neither it is in distance field mode
+    if (!shape().isRectangular() && m_mode == Mode::Tessellated && !deferUpdate(PendingRebuild))
     {
-        const bool wasAtlas = (!m_texture || m_texture->isAtlasTexture());
+        rebuildGeometry();
+        enforceMemoryBudget();
+    }
 
-        m_texture = texture;
+    return true;
+}
 
-        // Unless we operate on atlas textures, it should be
-        // fine to not rebuild the geometry
-        if (wasAtlas || texture->isAtlasTexture())
-            rebuildGeometry(); // Texture coordinate mismatch
+void QSGRoundedRectangularImageNode::setTopology(const Topology topology)
+{
+    if (m_topology == topology)
+        return;
+
+    m_topology = topology;
+
+    if (m_shape.isValid() && !deferUpdate(PendingRebuild))
+    {
+        rebuildGeometry();
+        enforceMemoryBudget();
     }
+}
+
+void QSGRoundedRectangularImageNode::setGeometrySharing(const bool enable)
+{
+    if (m_geometrySharing == enable)
+        return;
 
-    material()->setTexture(texture.get());
-    opaqueMaterial()->setTexture(texture.get());
+    m_geometrySharing = enable;
 
-    markDirty(QSGNode::DirtyMaterial);
+    if (m_shape.isValid() && !deferUpdate(PendingRebuild))
+        rebuildGeometry();
 }
 
-bool QSGRoundedRectangularImageNode::setShape(const Shape& shape)
+void QSGRoundedRectangularImageNode::setDeferredUpdates(const bool enable)
 {
-    if (m_shape == shape)
+    if (m_deferredUpdates == enable)
+        return;
+
+    // Nothing is left pending once updates are done right away
+    if (!enable)
+        commit();
+
+    m_deferredUpdates = enable;
+
+    updatePreprocessFlag();
+}
+
+void QSGRoundedRectangularImageNode::setCulled(const bool culled)
+{
+    if (m_culled == culled)
+        return;
+
+    m_culled = culled;
+
+    markDirty(QSGNode::DirtySubtreeBlocked);
+
+    // Catch up with the changes made while culled
+    if (!culled && !m_deferredUpdates)
+        commit();
+}
+
+bool QSGRoundedRectangularImageNode::isSubtreeBlocked() const
+{
+    return m_culled;
+}
+
+bool QSGRoundedRectangularImageNode::deferUpdate(const int update)
+{
+    if (!updatesDeferred())
         return false;
 
-    const bool ret = rebuildGeometry(shape);
+    m_pendingUpdates |= update;
+    return true;
+}
+
+void QSGRoundedRectangularImageNode::commit()
+{
+    // Done once the node is visible again,
+    // or once it has a texture
+    if (m_culled || !m_texture)
+        return;
+
+    const int pendingUpdates = std::exchange(m_pendingUpdates, 0);
+    if (pendingUpdates == 0)
+        return;
+
+    const Shape shape = (pendingUpdates & PendingShape) ? m_pendingShape : m_shape;
+
+    // A single rebuild covers all of the pending updates
+    bool rebuild = (pendingUpdates & PendingRebuild);
+
+    if ((pendingUpdates & PendingShape) && !isTranslation(shape))
+    {
+        startCoarsePhase();
+        rebuild = true;
+    }
+
+    if ((pendingUpdates & PendingTextureCoordinates) && (m_geometrySharing || !m_shape.isValid()))
+        rebuild = true; // Might need to switch between shared and own geometry
+
+    if (rebuild)
+    {
+        if (rebuildGeometry(shape))
+            m_shape = shape;
+    }
+    else
+    {
+        if (pendingUpdates & PendingShape)
+            applyShape(shape);
+
+        if (pendingUpdates & PendingTextureCoordinates)
+            updateTextureCoordinates();
+    }
+
+    enforceMemoryBudget();
+}
+
+void QSGRoundedRectangularImageNode::preprocess()
+{
+    commit();
+
+    if (!m_coarse)
+        return;
+
+    // The frame that the shape has changed in counts as well
+    if (++m_stableFrames > m_levelOfDetail.stableFrameCount)
+    {
+        m_coarse = false;
+        rebuildGeometry();
+    }
+    else if (m_frameRequestHandler)
+    {
+        // Frames are needed to count them
+        m_frameRequestHandler();
+    }
+}
+
+void QSGRoundedRectangularImageNode::setLevelOfDetail(const LevelOfDetail& levelOfDetail)
+{
+    if (m_levelOfDetail == levelOfDetail)
+        return;
+
+    m_levelOfDetail = levelOfDetail;
+
+    updatePreprocessFlag();
+
+    if (!m_levelOfDetail.isEnabled() && m_coarse)
+    {
+        m_coarse = false;
+
+        if (m_shape.isValid() && !deferUpdate(PendingRebuild))
+            rebuildGeometry();
+    }
+}
+
+void QSGRoundedRectangularImageNode::setFrameRequestHandler(const FrameRequestHandler& handler)
+{
+    m_frameRequestHandler = handler;
+}
+
+void QSGRoundedRectangularImageNode::startCoarsePhase()
+{
+    if (!m_levelOfDetail.isEnabled() || m_mode != Mode::Tessellated)
+        return;
+
+    m_coarse = true;
+    m_stableFrames = 0;
+}
+
+QSGRoundedRectangularImageNode::Tessellation QSGRoundedRectangularImageNode::effectiveTessellation() const
+{
+    if (!m_coarse)
+        return m_tessellation;
+
+    Tessellation tessellation = m_tessellation;
+    tessellation.tolerance = std::max(tessellation.tolerance, m_levelOfDetail.tolerance);
+    return tessellation;
+}
+
+void QSGRoundedRectangularImageNode::updatePreprocessFlag()
+{
+    setFlag(QSGNode::UsePreprocess, m_deferredUpdates || m_levelOfDetail.isEnabled());
+}
+
+bool QSGRoundedRectangularImageNode::rebuildSharedGeometry(const Shape& shape)
+{
+    if (!shape.isValid())
+        return false;
+
+    std::shared_ptr<QSGGeometry> sharedGeometry = SharedGeometryRegistry::geometry(shape, effectiveTessellation(), m_topology);
+    if (sharedGeometry == m_sharedGeometry)
+        return true;
+
+    // Deletes the old geometry if it is owned:
+    setGeometry(sharedGeometry.get());
+    setFlag(QSGGeometryNode::OwnsGeometry, false);
+
+    m_sharedGeometry = std::move(sharedGeometry);
+
+    return true;
+}
+
+bool QSGRoundedRectangularImageNode::rebuildGeometry(const Shape& shape)
+{
+    // In distance field mode, corners are rounded by the material
+    const bool ret = rebuildGeometryOnly((m_mode == Mode::DistanceField) ? Shape {shape.rect, 0.0} : shape);
 
     if (ret)
-        m_shape = shape;
+        ++m_rebuildCount;
+
+    if (ret && m_mode == Mode::DistanceField)
+        updateDistanceFieldMaterial(shape);
+
+    updateMemoryAccounting();
 
     return ret;
 }
 
-bool QSGRoundedRectangularImageNode::rebuildGeometry(const Shape& shape)
+QSGGeometry* QSGRoundedRectangularImageNode::reusableGeometry() const
 {
     QSGGeometry* const geometry = this->geometry();
-    QSGGeometry* const rebuiltGeometry = rebuildGeometry(shape,
+
+    // Shared geometry must not be modified, and geometry
+    // of another topology can not be reconstructed
+    if (m_sharedGeometry || (geometry && geometry->drawingMode() != drawingMode(m_topology)))
+        return nullptr;
+
+    return geometry;
+}
+
+bool QSGRoundedRectangularImageNode::rebuildGeometryOnly(const Shape& shape)
+{
+    if (!m_texture)
+        return false;
+
+    // Atlas textures need their own texture coordinates
+    if (m_geometrySharing && !m_texture->isAtlasTexture())
+        return rebuildSharedGeometry(shape);
+
+    // Own geometry is placed at the origin as well while
+    // sharing, so that the node stays in place when its
+    // texture switches between atlas and plain ones
+    Shape placedShape = shape;
+    if (m_geometrySharing)
+        placedShape.rect.moveTopLeft({});
+
+    QSGGeometry* const geometry = reusableGeometry();
+
+    QSGGeometry* const rebuiltGeometry = rebuildGeometry(placedShape,
                                                          geometry,
                                                          m_texture->isAtlasTexture() ? m_texture.get()
-                                                                                     : nullptr);
+                                                                                     : nullptr,
+                                                         effectiveTessellation(),
+                                                         m_topology);
     if (!rebuiltGeometry)
     {
         return false;
@@ -146,6 +1898,12 @@ bool QSGRoundedRectangularImageNode::rebuildGeometry(const Shape& shape)
         // - Dirty bit set implicitly
         // - No need to remove the old geometry
         setGeometry(rebuiltGeometry);
+
+        if (m_sharedGeometry)
+        {
+            setFlag(QSGGeometryNode::OwnsGeometry);
+            m_sharedGeometry.reset();
+        }
     }
 
     return true;
@@ -153,81 +1911,78 @@ bool QSGRoundedRectangularImageNode::rebuildGeometry(const Shape& shape)
 
 QSGGeometry* QSGRoundedRectangularImageNode::rebuildGeometry(const Shape& shape,
                                                              QSGGeometry* geometry,
-                                                             const QSGTexture* const atlasTexture)
+                                                             const QSGTexture* const atlasTexture,
+                                                             const Tessellation& tessellation,
+                                                             const Topology topology)
 {
-    if (!shape.isValid())
+    if (!shape.isValid() || !tessellation.isValid())
         return nullptr;
 
-    int vertexCount;
+    QSGROUNDEDRECTANGULARIMAGENODE_ZONE("RoundedRectangularImage rebuildGeometry");
+
+    const Corners corners(shape, tessellation);
 
-    QVector<QPointF> *path;
-    std::unique_ptr<QVector<QPointF>> upPath;
+    const bool indexed = (topology == Topology::IndexedTriangles);
+
+    int vertexCount;
+    int indexCount;
 
-    if (qFuzzyIsNull(shape.radius))
+    if (corners.isRectangular())
     {
         // 4 vertices are needed to construct
-        // a rectangle using triangle strip.
+        // a rectangle using triangle strip,
+        // or two triangles.
         vertexCount = 4;
-        path = nullptr; // unused
+        indexCount = indexed ? 6 : 0;
     }
     else
     {
-        using SizePair = QPair<qreal, qreal>;
-        using ShapePair = QPair<SizePair, qreal>;
-
         // We could cache QSGGeometry itself, but
         // it would not be really useful for atlas
         // textures.
-        static QCache<ShapePair, QVector<QPointF>> paths;
+        vertexCount = corners.vertexCount();
+        indexCount = 0;
 
-        ShapePair key {{shape.rect.width(), shape.rect.height()}, {shape.radius}};
-        if (paths.contains(key))
-        {
-            // There is no cache manipulation after this point,
-            // so path is assumed to be valid within its scope
-            path = paths.object(key);
-        }
-        else
+        if (indexed)
         {
-            QPainterPath painterPath;
-            painterPath.addRoundedRect(0, 0, key.first.first, key.first.second, key.second, key.second);
-            painterPath = painterPath.simplified();
-
-            upPath = std::make_unique<QVector<QPointF>>(painterPath.elementCount());
-            path = upPath.get();
-
-            const int elementCount = painterPath.elementCount();
-            for (int i = 0; i < elementCount; ++i)
-            {
-                // QPainterPath is not necessarily compatible with
-                // with GPU primitives. However, simplified painter path
-                // with rounded rectangle shape consists of painter path
-                // elements of types which can be drawn using primitives.
-                assert(painterPath.elementAt(i).type == QPainterPath::ElementType::MoveToElement
-                       || painterPath.elementAt(i).type == QPainterPath::ElementType::LineToElement);
-
-                // Symmetry based triangulation based on ordered painter path.
-                (*path)[i] = (painterPath.elementAt((i % 2) ? (i)
-                                                            : (elementCount - i - 1)));
-            }
-
-            paths.insert(key, new QVector<QPointF>(*path));
+            // Fan around the center
+            indexCount = 3 * vertexCount;
+            vertexCount += 1;
         }
-
-        vertexCount = path->count();
     }
 
+    geometryCounters.rebuilds.fetch_add(1, std::memory_order_relaxed);
+    geometryCounters.vertices.fetch_add(vertexCount, std::memory_order_relaxed);
+
     if (!geometry)
     {
-        geometry = new QSGGeometry(QSGGeometry::defaultAttributes_TexturedPoint2D(), vertexCount);
-        geometry->setIndexDataPattern(QSGGeometry::StaticPattern); // Is this necessary? Indexing is not used
+        geometryCounters.allocations.fetch_add(1, std::memory_order_relaxed);
+
+        geometry = new QSGGeometry(QSGGeometry::defaultAttributes_TexturedPoint2D(),
+                                   vertexCount,
+                                   indexCount,
+                                   QSGGeometry::UnsignedShortType);
+        geometry->setIndexDataPattern(QSGGeometry::StaticPattern); // Only used with indexed triangles
         geometry->setVertexDataPattern(QSGGeometry::StaticPattern);
-        geometry->setDrawingMode(QSGGeometry::DrawingMode::DrawTriangleStrip);
+        geometry->setDrawingMode(drawingMode(topology));
     }
     else
     {
-        // Size check is implicitly done:
-        geometry->allocate(vertexCount);
+        // Buffers that are already large enough are kept as they
+        // are, the excess is filled with degenerate triangles below.
+        // Vertex counts fluctuating a little from one rebuild to
+        // another, such as during radius animations, do not cause
+        // reallocations this way. Buffers that became much larger
+        // than needed are still shrunk.
+        const auto fits = [](const int count, const int capacity) {
+            return (count <= capacity && capacity <= count * maximumPaddingRatio);
+        };
+
+        if (!fits(vertexCount, geometry->vertexCount()) || !fits(indexCount, geometry->indexCount()))
+        {
+            geometryCounters.allocations.fetch_add(1, std::memory_order_relaxed);
+            geometry->allocate(vertexCount, indexCount);
+        }
 
         // Assume the passed geometry is not a stray one.
         // It is possible to check and create a new QSGGeometry
@@ -241,7 +1996,8 @@ QSGGeometry* QSGRoundedRectangularImageNode::rebuildGeometry(const Shape& shape,
         assert(geometry->indexDataPattern() == QSGGeometry::StaticPattern);
         assert(geometry->vertexDataPattern() == QSGGeometry::StaticPattern);
 
-        assert(geometry->drawingMode() == QSGGeometry::DrawingMode::DrawTriangleStrip);
+        assert(geometry->drawingMode() == drawingMode(topology));
+        assert(!indexed || geometry->indexType() == QSGGeometry::UnsignedShortType);
         assert(geometry->attributes() == QSGGeometry::defaultAttributes_TexturedPoint2D().attributes);
         assert(geometry->sizeOfVertex() == QSGGeometry::defaultAttributes_TexturedPoint2D().stride);
     }
@@ -258,33 +2014,28 @@ QSGGeometry* QSGRoundedRectangularImageNode::rebuildGeometry(const Shape& shape,
         texNormalSubRect = {0.0, 0.0, 1.0, 1.0};
     }
 
-    if (qFuzzyIsNull(shape.radius))
+    if (corners.isRectangular())
     {
         // Use the helper function to reconstruct the pure rectangular geometry:
         QSGGeometry::updateTexturedRectGeometry(geometry, shape.rect, texNormalSubRect);
+
+        if (indexed)
+        {
+            quint16* const indices = geometry->indexDataAsUShort();
+            const quint16 rectIndices[] = {0, 1, 2, 2, 1, 3};
+            std::copy(std::begin(rectIndices), std::end(rectIndices), indices);
+        }
     }
     else
     {
-        const auto mapToAtlasTexture = [texNormalSubRect] (const QPointF& nPoint) -> QPointF {
-            return {texNormalSubRect.x() + (texNormalSubRect.width() * nPoint.x()),
-                texNormalSubRect.y() + (texNormalSubRect.height() * nPoint.y())};
-        };
-
-        QSGGeometry::TexturedPoint2D* const points = geometry->vertexDataAsTexturedPoint2D();
+        fillRoundedRect(geometry->vertexDataAsTexturedPoint2D(), shape.rect, corners, texNormalSubRect, topology);
 
-        const qreal dx = shape.rect.x();
-        const qreal dy = shape.rect.y();
-        for (int i = 0; i < geometry->vertexCount(); ++i)
-        {
-            const QPointF& pos = path->at(i);
-            QPointF tPos = {pos.x() / shape.rect.width(), pos.y() / shape.rect.height()};
-            if (atlasTexture)
-                tPos = mapToAtlasTexture(tPos);
-
-            points[i].set(pos.x() + dx, pos.y() + dy, tPos.x(), tPos.y());
-        }
+        if (indexed)
+            fillFanIndices(geometry->indexDataAsUShort(), vertexCount - 1);
     }
 
+    padGeometry(geometry, vertexCount, indexCount);
+
     geometry->markIndexDataDirty();
     geometry->markVertexDataDirty();
 
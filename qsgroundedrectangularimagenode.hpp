@@ -26,28 +26,88 @@
 #define QSGROUNDEDRECTANGULARIMAGENODE_HPP
 
 #include <QSGGeometryNode>
+#include <QSGTexture>
+#include <QVector>
 
 #include <memory>
+#include <functional>
 #include <cmath>
+#include <cassert>
 
 class QSGTextureMaterial;
 class QSGOpaqueTextureMaterial;
-class QSGTexture;
+class QSGRoundedRectangularImageMaterial;
+class QQuickWindow;
 
 class QSGRoundedRectangularImageNode : public QSGGeometryNode
 {
+public:
+    // Checked cast, only checked in debug builds
     template<class T>
-    static T material_cast(QSGMaterial* const material);
+    static T material_cast(QSGMaterial* const material)
+    {
+#ifdef NDEBUG
+        return static_cast<T>(material);
+#else
+        const auto ret = dynamic_cast<T>(material);
+        assert(ret); // incompatible material type
+        return ret;
+#endif
+    }
 
-public:
     struct Shape
     {
         QRectF rect;
         qreal radius = 0.0;
 
+        // Radii of the individual corners. Negative
+        // values mean that `radius` is used instead.
+        qreal topLeftRadius = -1.0;
+        qreal topRightRadius = -1.0;
+        qreal bottomRightRadius = -1.0;
+        qreal bottomLeftRadius = -1.0;
+
+        constexpr qreal cornerRadius(const Qt::Corner corner) const
+        {
+            qreal cornerRadius = -1.0;
+            switch (corner)
+            {
+            case Qt::TopLeftCorner:
+                cornerRadius = topLeftRadius;
+                break;
+            case Qt::TopRightCorner:
+                cornerRadius = topRightRadius;
+                break;
+            case Qt::BottomRightCorner:
+                cornerRadius = bottomRightRadius;
+                break;
+            case Qt::BottomLeftCorner:
+                cornerRadius = bottomLeftRadius;
+                break;
+            }
+
+            return (cornerRadius < 0.0) ? radius : cornerRadius;
+        }
+
+        constexpr bool hasSameRadii(const Shape& b) const
+        {
+            return (qFuzzyCompare(cornerRadius(Qt::TopLeftCorner), b.cornerRadius(Qt::TopLeftCorner)) &&
+                    qFuzzyCompare(cornerRadius(Qt::TopRightCorner), b.cornerRadius(Qt::TopRightCorner)) &&
+                    qFuzzyCompare(cornerRadius(Qt::BottomRightCorner), b.cornerRadius(Qt::BottomRightCorner)) &&
+                    qFuzzyCompare(cornerRadius(Qt::BottomLeftCorner), b.cornerRadius(Qt::BottomLeftCorner)));
+        }
+
+        constexpr bool isRectangular() const
+        {
+            return (qFuzzyIsNull(cornerRadius(Qt::TopLeftCorner)) &&
+                    qFuzzyIsNull(cornerRadius(Qt::TopRightCorner)) &&
+                    qFuzzyIsNull(cornerRadius(Qt::BottomRightCorner)) &&
+                    qFuzzyIsNull(cornerRadius(Qt::BottomLeftCorner)));
+        }
+
         constexpr bool operator ==(const Shape& b) const
         {
-            return (rect == b.rect && qFuzzyCompare(radius, b.radius));
+            return (rect == b.rect && hasSameRadii(b));
         }
 
         constexpr bool isValid() const
@@ -56,22 +116,258 @@ public:
         }
     };
 
+    // Determines how finely the corners are approximated
+    struct Tessellation
+    {
+        // Ratio of device pixels to logical pixels of
+        // the window that the node is rendered in
+        qreal devicePixelRatio = 1.0;
+
+        // Maximum distance, in device pixels, between the
+        // ideal corner arc and the geometry approximating it
+        qreal tolerance = 0.5;
+
+        constexpr bool operator ==(const Tessellation& b) const
+        {
+            return (qFuzzyCompare(devicePixelRatio, b.devicePixelRatio) && qFuzzyCompare(tolerance, b.tolerance));
+        }
+
+        constexpr bool isValid() const
+        {
+            return (std::isgreater(devicePixelRatio, 0.0) && std::isgreater(tolerance, 0.0));
+        }
+
+        // Number of segments a corner with the given
+        // radius (in logical pixels) is divided into
+        int cornerSegmentCount(const qreal radius) const;
+    };
+
+    // Geometry is tessellated coarser while the shape keeps changing,
+    // such as during animations, and with the full quality again once
+    // it has not changed for a number of frames. Frames are counted in
+    // preprocess(), so this is to be enabled before the node is added
+    // to the scene.
+    struct LevelOfDetail
+    {
+        // Tolerance used while the shape changes, disabled if not positive
+        qreal tolerance = 0.0;
+
+        // Frames the shape needs to stay the same for full quality
+        int stableFrameCount = 3;
+
+        constexpr bool operator ==(const LevelOfDetail& b) const
+        {
+            return (qFuzzyCompare(tolerance, b.tolerance) && stableFrameCount == b.stableFrameCount);
+        }
+
+        constexpr bool isEnabled() const
+        {
+            return std::isgreater(tolerance, 0.0);
+        }
+    };
+
+    struct PathCacheStatistics
+    {
+        quint64 hits = 0;
+        quint64 misses = 0;
+        quint64 evictions = 0;
+        qsizetype residentBytes = 0;
+        qsizetype capacity = 0;
+    };
+
+    // Totals over all geometries constructed by rebuildGeometry()
+    struct GeometryStatistics
+    {
+        quint64 rebuilds = 0;
+        quint64 vertices = 0;
+        // New geometries, and reallocations of the existing ones
+        quint64 allocations = 0;
+    };
+
+    // Memory used by the nodes, in bytes. Sizes of the path cache
+    // and of the shared geometries are only reported in total.
+    struct MemoryStatistics
+    {
+        qsizetype pathCacheBytes = 0;
+        qsizetype sharedGeometryBytes = 0;
+        // Geometries owned by the nodes
+        qsizetype geometryBytes = 0;
+        qsizetype materialBytes = 0;
+        qsizetype nodeCount = 0;
+
+        constexpr qsizetype totalBytes() const
+        {
+            return pathCacheBytes + sharedGeometryBytes + geometryBytes + materialBytes;
+        }
+    };
+
+    // Counters of the nodes accounted to a window, which
+    // the nodes hold on to so that updating them takes no lock
+    struct MemoryCounters;
+
+    // What a node gives up when the memory budget is exceeded by
+    // its update, after the path cache is shrunk. Shared geometry
+    // is placed at the origin, so it only suits nodes positioned
+    // by a transform node.
+    enum class BudgetFallback
+    {
+        None,
+        SharedGeometry,
+        DistanceField
+    };
+
+    enum class Mode
+    {
+        // Corners are part of the geometry
+        Tessellated,
+        // Geometry is a plain rectangle, corners are
+        // rounded and antialiased in the fragment shader
+        DistanceField
+    };
+
+    enum class Topology
+    {
+        // Outline zigzagged in a single strip, no indices
+        TriangleStrip,
+        // Fan of triangles around the center, with 16-bit
+        // indices. Easier to merge for the renderer.
+        IndexedTriangles
+    };
+
     QSGRoundedRectangularImageNode();
+    ~QSGRoundedRectangularImageNode() override;
 
-    // For convenience:
+    // For convenience (only in tessellated mode):
     QSGTextureMaterial* material() const;
     QSGOpaqueTextureMaterial* opaqueMaterial() const;
 
     void setSmooth(const bool smooth);
+
+    // Textures must be minified at least this much (texture size to
+    // size on the screen, in device pixels) for mipmaps to be used
+    inline constexpr qreal mipmapThreshold() const
+    {
+        return m_mipmapThreshold;
+    }
+
+    void setMipmapThreshold(const qreal threshold);
+
+    // How much the texture, or its part given in normalized texture
+    // coordinates, is minified when drawn at the given size in device
+    // pixels, and the mipmap filtering to use for that. Plain textures
+    // are mipmapped past the threshold, atlas textures only if they
+    // have mipmaps. Shared with the batch node.
+    static qreal minification(const QSGTexture& texture, const QRectF& texNormalSubRect, const QSizeF& targetSize);
+    static QSGTexture::Filtering mipmapFiltering(const QSGTexture& texture,
+                                                 const qreal minification,
+                                                 const bool smooth,
+                                                 const qreal threshold);
+
+    // Called once per atlas texture that should be mipmapped, as
+    // atlas textures can not have mipmaps. The handler may provide
+    // a plain texture instead with setTexture().
+    using MipmapRequestHandler = std::function<void(const std::shared_ptr<QSGTexture>& texture)>;
+    void setMipmapRequestHandler(const MipmapRequestHandler& handler);
     void setTexture(const std::shared_ptr<QSGTexture>& texture);
 
+    inline constexpr Mode mode() const
+    {
+        return m_mode;
+    }
+
+    void setMode(const Mode mode);
+
     inline constexpr Shape shape() const
     {
-        return m_shape;
+        return (m_pendingUpdates & PendingShape) ? m_pendingShape : m_shape;
     }
 
     bool setShape(const Shape& shape);
 
+    inline constexpr Tessellation tessellation() const
+    {
+        return m_tessellation;
+    }
+
+    bool setTessellation(const Tessellation& tessellation);
+
+    inline constexpr Topology topology() const
+    {
+        return m_topology;
+    }
+
+    void setTopology(const Topology topology);
+
+    inline constexpr bool geometrySharing() const
+    {
+        return m_geometrySharing;
+    }
+
+    // When enabled, nodes with the same shape size, radius and
+    // tessellation share a single, immutable geometry, as long as
+    // they do not use atlas textures. The geometry, shared or not, is
+    // placed at the origin regardless of the position of the shape, so
+    // the node is expected to be positioned by a parent transform node.
+    void setGeometrySharing(const bool enable);
+
+    inline constexpr bool deferredUpdates() const
+    {
+        return m_deferredUpdates;
+    }
+
+    // When enabled, the geometry updates that the setters would
+    // do are recorded instead, and done at once on commit(), or
+    // right before rendering in preprocess(). Several changes
+    // made in one go then cost a single rebuild at most. The
+    // renderer only picks up the preprocess flag of the nodes being
+    // added, so enable this before adding the node to the scene.
+    void setDeferredUpdates(const bool enable);
+    void commit();
+
+    void preprocess() override;
+
+    inline constexpr bool isCulled() const
+    {
+        return m_culled;
+    }
+
+    // Culled nodes are not rendered, and the geometry updates
+    // that the setters would do are deferred until the node is
+    // no longer culled, for example while it is outside of the
+    // viewport. They are then done at once, right away unless
+    // deferred updates are enabled.
+    void setCulled(const bool culled);
+
+    inline constexpr LevelOfDetail levelOfDetail() const
+    {
+        return m_levelOfDetail;
+    }
+
+    void setLevelOfDetail(const LevelOfDetail& levelOfDetail);
+
+    // Called from preprocess() while frames are needed to return to
+    // the full quality, as the renderer might otherwise have no reason
+    // to render them. QQuickWindow::update() is usually a good fit.
+    using FrameRequestHandler = std::function<void()>;
+    void setFrameRequestHandler(const FrameRequestHandler& handler);
+
+    inline constexpr const QQuickWindow* accountingWindow() const
+    {
+        return m_accountingWindow;
+    }
+
+    // Window that the memory of the node is accounted to
+    void setAccountingWindow(const QQuickWindow* const window);
+
+    inline constexpr BudgetFallback budgetFallback() const
+    {
+        return m_budgetFallback;
+    }
+
+    void setBudgetFallback(const BudgetFallback fallback);
+
+    bool isSubtreeBlocked() const override;
+
     inline bool rebuildGeometry()
     {
         return rebuildGeometry(m_shape);
@@ -79,15 +375,139 @@ public:
 
     bool rebuildGeometry(const Shape& shape);
 
-    // Constructs a geometry denoting rounded rectangle using QPainterPath
+    // Number of successful rebuilds of this node, useful to find
+    // out which nodes are responsible for geometry construction
+    inline constexpr quint64 rebuildCount() const
+    {
+        return m_rebuildCount;
+    }
+
+    struct ShapeUpdate
+    {
+        QSGRoundedRectangularImageNode* node;
+        Shape shape;
+    };
+
+    // Same as calling setShape() on each of the nodes, except that
+    // the geometries are built in parallel, in the global thread pool.
+    // Nodes are only modified by the calling thread, which should
+    // be the render thread. A node must appear only once. Defined in
+    // qsgroundedrectangularimagebulkupdate.cpp, which needs Qt Concurrent.
+    static void setShapes(const QVector<ShapeUpdate>& updates);
+
+    // Constructs a geometry denoting rounded rectangle. A given
+    // geometry keeps its buffers when they are large enough, in
+    // which case the excess is made up of degenerate triangles.
     static QSGGeometry* rebuildGeometry(const Shape& shape,
                                         QSGGeometry* geometry,
-                                        const QSGTexture* const atlasTexture = nullptr);
+                                        const QSGTexture* const atlasTexture = nullptr,
+                                        const Tessellation& tessellation = {},
+                                        const Topology topology = Topology::TriangleStrip);
+
+    // Number of vertices and the vertices themselves, in triangle
+    // strip order, of the geometry that denotes the given shape.
+    // Useful for nodes that pack multiple shapes in one geometry.
+    static int vertexCount(const Shape& shape, const Tessellation& tessellation = {});
+    static void fillVertices(QSGGeometry::TexturedPoint2D* const points,
+                             const Shape& shape,
+                             const QRectF& texNormalSubRect = {0.0, 0.0, 1.0, 1.0},
+                             const Tessellation& tessellation = {});
+
+    // The path cache is shared by all nodes. Cost of
+    // an entry is the size of its vertices, in bytes.
+    static void setPathCacheCapacity(const qsizetype bytes);
+
+    // Builds the cache entries the given shapes need ahead of
+    // time, so that nodes using them do not miss. Can be called
+    // from any thread, such as a worker thread while a view is
+    // being loaded.
+    static void prewarmPathCache(const QVector<Shape>& shapes, const Tessellation& tessellation = {});
+
+    static qsizetype pathCacheCapacity();
+    static PathCacheStatistics pathCacheStatistics();
+
+    // Meant for comparing the cost of geometry construction, for
+    // example vertices per second or allocations per rebuild, by
+    // taking the difference of two snapshots
+    static GeometryStatistics geometryStatistics();
+
+    // Memory used in total, or by the nodes accounted to a window
+    static MemoryStatistics memoryStatistics();
+    static MemoryStatistics memoryStatistics(const QQuickWindow* const window);
+
+    // Total size, in bytes, that the updates of the nodes try
+    // to keep the memory usage under. Not positive means no budget.
+    static void setMemoryBudget(const qsizetype bytes);
+    static qsizetype memoryBudget();
 
 private:
+    enum PendingUpdate
+    {
+        PendingShape = 0x1,
+        PendingTextureCoordinates = 0x2,
+        PendingRebuild = 0x4
+    };
+
+    QSGRoundedRectangularImageMaterial* distanceFieldMaterial() const;
+
+    // Returns true if the filtering has changed
+    bool applyFiltering();
+    void applyTexture();
+
+    // Returns false if updates are not deferred, so
+    // that the update should be done right away
+    bool deferUpdate(const int update);
+
+    inline constexpr bool updatesDeferred() const
+    {
+        return (m_deferredUpdates || m_culled);
+    }
+
+    void updateMemoryAccounting();
+    void enforceMemoryBudget();
+
+    void updatePreprocessFlag();
+    void startCoarsePhase();
+    Tessellation effectiveTessellation() const;
+
+    bool isTranslation(const Shape& shape) const;
+    bool applyShape(const Shape& shape);
+
+    // Geometry that can be rebuilt in place, if any
+    QSGGeometry* reusableGeometry() const;
+
+    bool rebuildGeometryOnly(const Shape& shape);
+    bool rebuildSharedGeometry(const Shape& shape);
+    void translateGeometry(const QPointF& delta);
+    void updateTextureCoordinates();
+    void updateDistanceFieldMaterial(const Shape& shape);
+
     std::shared_ptr<QSGTexture> m_texture;
+    MipmapRequestHandler m_mipmapRequestHandler;
+    FrameRequestHandler m_frameRequestHandler;
+    std::shared_ptr<QSGGeometry> m_sharedGeometry;
     Shape m_shape;
+    Shape m_pendingShape;
+    Tessellation m_tessellation;
+    LevelOfDetail m_levelOfDetail;
+    Mode m_mode = Mode::Tessellated;
+    Topology m_topology = Topology::TriangleStrip;
+    BudgetFallback m_budgetFallback = BudgetFallback::None;
+    const QQuickWindow* m_accountingWindow = nullptr;
+    std::shared_ptr<MemoryCounters> m_memoryCounters;
+    qsizetype m_accountedGeometryBytes = 0;
+    qsizetype m_accountedMaterialBytes = 0;
+    qreal m_mipmapThreshold = 2.0;
     bool m_smooth = true;
+    bool m_mipmapsRequested = false;
+    bool m_requestingMipmaps = false;
+    bool m_geometrySharing = false;
+    bool m_deferredUpdates = false;
+    bool m_culled = false;
+    bool m_coarse = false;
+    int m_stableFrames = 0;
+    int m_pendingUpdates = 0;
+    quint64 m_rebuildCount = 0;
 };
 
 #endif // QSGROUNDEDRECTANGULARIMAGENODE_HPP
@@ -0,0 +1,249 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Fatih Uzunoglu <fuzun54@outlook.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "roundedimage.hpp"
+#include "qsgroundedrectangularimagenode.hpp"
+
+#include <QQuickWindow>
+#include <QSGTexture>
+#include <QHash>
+#include <QMutex>
+#include <QVector>
+
+#include <memory>
+
+namespace
+{
+
+// Free nodes of each window. Nodes are only ever used in the window
+// that they were created for, as their resources belong to its scene
+// graph, and they are deleted once the scene graph is invalidated.
+class NodePool
+{
+public:
+    static QSGRoundedRectangularImageNode* acquire(QQuickWindow* const window)
+    {
+        assert(window);
+
+        NodePool& pool = instance();
+        const QMutexLocker locker(&pool.m_mutex);
+
+        auto it = pool.m_entries.find(window);
+        if (it == pool.m_entries.end())
+        {
+            it = pool.m_entries.insert(window, {});
+
+            // Render thread of the window, with
+            // its graphics resources still valid:
+            it->connection = QObject::connect(window, &QQuickWindow::sceneGraphInvalidated, window, [window]() {
+                clear(window);
+            }, Qt::DirectConnection);
+        }
+
+        if (!it->nodes.isEmpty())
+            return it->nodes.takeLast();
+
+        const auto node = new QSGRoundedRectangularImageNode;
+
+        // Owned by the pool:
+        node->setFlag(QSGNode::OwnedByParent, false);
+        node->setAccountingWindow(window);
+
+        // Texture and shape are usually both set at
+        // once, which should not cost two rebuilds:
+        node->setDeferredUpdates(true);
+
+        return node;
+    }
+
+    static void release(QQuickWindow* const window, QSGRoundedRectangularImageNode* const node)
+    {
+        assert(node);
+        assert(!node->parent());
+
+        {
+            NodePool& pool = instance();
+            const QMutexLocker locker(&pool.m_mutex);
+
+            // Not kept if the scene graph is already gone
+            const auto it = pool.m_entries.find(window);
+            if (it != pool.m_entries.end() && it->nodes.size() < maximumNodeCount)
+            {
+                it->nodes.append(node);
+                return;
+            }
+        }
+
+        delete node;
+    }
+
+private:
+    // Pooled nodes keep their last texture
+    // and geometry, so the pool is bounded
+    static constexpr qsizetype maximumNodeCount = 256;
+
+    static NodePool& instance()
+    {
+        static NodePool pool;
+        return pool;
+    }
+
+    struct Entry
+    {
+        QVector<QSGRoundedRectangularImageNode*> nodes;
+        // Made again along with the entry
+        QMetaObject::Connection connection;
+    };
+
+    static void clear(QQuickWindow* const window)
+    {
+        Entry entry;
+
+        {
+            NodePool& pool = instance();
+            const QMutexLocker locker(&pool.m_mutex);
+            entry = pool.m_entries.take(window);
+        }
+
+        QObject::disconnect(entry.connection);
+        qDeleteAll(entry.nodes);
+    }
+
+    QMutex m_mutex;
+    QHash<QQuickWindow*, Entry> m_entries;
+};
+
+// Paint node of the item. It holds a pooled node as its child,
+// which is given back to the pool instead of being deleted
+// along with it.
+class RoundedImageNode : public QSGNode
+{
+public:
+    explicit RoundedImageNode(QQuickWindow* const window)
+        : m_window(window)
+        , m_node(NodePool::acquire(window))
+    {
+        appendChildNode(m_node);
+    }
+
+    ~RoundedImageNode() override
+    {
+        removeChildNode(m_node);
+        NodePool::release(m_window, m_node);
+    }
+
+    inline QSGRoundedRectangularImageNode* node() const
+    {
+        return m_node;
+    }
+
+private:
+    QQuickWindow* const m_window;
+    QSGRoundedRectangularImageNode* const m_node;
+};
+
+}
+
+RoundedImage::RoundedImage(QQuickItem* const parent)
+    : QQuickItem(parent)
+{
+    setFlag(QQuickItem::ItemHasContents);
+
+    connect(this, &QQuickItem::smoothChanged, this, &QQuickItem::update);
+    connect(this, &QQuickItem::widthChanged, this, &QQuickItem::update);
+    connect(this, &QQuickItem::heightChanged, this, &QQuickItem::update);
+}
+
+void RoundedImage::setImage(const QImage& image)
+{
+    // Comparing the pixels would cost more than
+    // uploading an image that did not change
+    if (m_image.cacheKey() == image.cacheKey())
+        return;
+
+    m_image = image;
+    m_dirtyImage = true;
+
+    emit imageChanged();
+    update();
+}
+
+void RoundedImage::setRadius(const qreal radius)
+{
+    if (qFuzzyCompare(m_radius, radius))
+        return;
+
+    m_radius = radius;
+
+    emit radiusChanged();
+    update();
+}
+
+QSGNode* RoundedImage::updatePaintNode(QSGNode* const oldNode, UpdatePaintNodeData*)
+{
+    auto node = static_cast<RoundedImageNode*>(oldNode);
+
+    const QSGRoundedRectangularImageNode::Shape shape {boundingRect(), m_radius};
+
+    if (m_image.isNull() || !shape.isValid())
+    {
+        delete node;
+        return nullptr;
+    }
+
+    if (!node)
+    {
+        node = new RoundedImageNode(window());
+
+        // Pooled node shows the image of another item
+        m_dirtyImage = true;
+    }
+
+    QSGRoundedRectangularImageNode* const imageNode = node->node();
+
+    if (m_dirtyImage)
+    {
+        const std::shared_ptr<QSGTexture> texture(window()->createTextureFromImage(m_image,
+                                                                                   QQuickWindow::TextureCanUseAtlas));
+        if (!texture)
+        {
+            delete node;
+            return nullptr;
+        }
+
+        imageNode->setTexture(texture);
+        m_dirtyImage = false;
+    }
+
+    QSGRoundedRectangularImageNode::Tessellation tessellation = imageNode->tessellation();
+    tessellation.devicePixelRatio = window()->effectiveDevicePixelRatio();
+
+    imageNode->setSmooth(smooth());
+    imageNode->setTessellation(tessellation);
+    imageNode->setShape(shape);
+    imageNode->commit();
+
+    return node;
+}
@@ -0,0 +1,75 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Fatih Uzunoglu <fuzun54@outlook.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#ifndef ROUNDEDIMAGE_HPP
+#define ROUNDEDIMAGE_HPP
+
+#include <QQuickItem>
+#include <QImage>
+#include <QtQml/qqmlregistration.h>
+
+// Item displaying an image with rounded corners, using
+// QSGRoundedRectangularImageNode. Nodes are pooled per window:
+// the node of a destroyed item is kept, with its materials and
+// geometry, and is given to the next item that needs one, which
+// spares the allocations when views recycle their delegates.
+class RoundedImage : public QQuickItem
+{
+    Q_OBJECT
+    QML_ELEMENT
+
+    Q_PROPERTY(QImage image READ image WRITE setImage NOTIFY imageChanged FINAL)
+    Q_PROPERTY(qreal radius READ radius WRITE setRadius NOTIFY radiusChanged FINAL)
+
+public:
+    explicit RoundedImage(QQuickItem* const parent = nullptr);
+
+    inline QImage image() const
+    {
+        return m_image;
+    }
+
+    void setImage(const QImage& image);
+
+    inline qreal radius() const
+    {
+        return m_radius;
+    }
+
+    void setRadius(const qreal radius);
+
+signals:
+    void imageChanged();
+    void radiusChanged();
+
+protected:
+    QSGNode* updatePaintNode(QSGNode* oldNode, UpdatePaintNodeData*) override;
+
+private:
+    QImage m_image;
+    qreal m_radius = 0.0;
+    bool m_dirtyImage = false;
+};
+
+#endif // ROUNDEDIMAGE_HPP
@@ -0,0 +1,36 @@
+#version 440
+
+layout(location = 0) in vec2 texCoord;
+layout(location = 1) in vec2 position;
+
+layout(location = 0) out vec4 fragColor;
+
+layout(std140, binding = 0) uniform buf {
+    mat4 qt_Matrix;
+    vec4 rect; // x, y, width, height
+    vec4 radii; // top left, top right, bottom right, bottom left
+    float qt_Opacity;
+};
+
+layout(binding = 1) uniform sampler2D source;
+
+void main()
+{
+    // Signed distance to the rounded rectangle,
+    // negative inside and positive outside:
+    vec2 halfSize = rect.zw * 0.5;
+    vec2 p = position - (rect.xy + halfSize);
+
+    // Radius of the corner of the quadrant that the fragment is in
+    vec2 r = (p.x > 0.0) ? radii.yz : radii.xw;
+    float radius = (p.y > 0.0) ? r.y : r.x;
+
+    vec2 q = abs(p) - halfSize + radius;
+    float distance = min(max(q.x, q.y), 0.0) + length(max(q, 0.0)) - radius;
+
+    // Antialias over a single pixel, regardless of the scale:
+    float coverage = clamp(0.5 - distance / max(fwidth(distance), 1.0e-5), 0.0, 1.0);
+
+    // Texture is premultiplied
+    fragColor = texture(source, texCoord) * (coverage * qt_Opacity);
+}
@@ -0,0 +1,21 @@
+#version 440
+
+layout(location = 0) in vec4 qt_VertexPosition;
+layout(location = 1) in vec2 qt_VertexTexCoord;
+
+layout(location = 0) out vec2 texCoord;
+layout(location = 1) out vec2 position;
+
+layout(std140, binding = 0) uniform buf {
+    mat4 qt_Matrix;
+    vec4 rect; // x, y, width, height
+    vec4 radii; // top left, top right, bottom right, bottom left
+    float qt_Opacity;
+};
+
+void main()
+{
+    texCoord = qt_VertexTexCoord;
+    position = qt_VertexPosition.xy;
+    gl_Position = qt_Matrix * qt_VertexPosition;
+}
@@ -0,0 +1,243 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Fatih Uzunoglu <fuzun54@outlook.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "qsgroundedrectangularimagevalidation.hpp"
+
+#include <QElapsedTimer>
+#include <QImage>
+#include <QPainter>
+#include <QPainterPath>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <memory>
+
+namespace
+{
+
+using Shape = QSGRoundedRectangularImageValidation::Shape;
+
+// Radii in the outline order, clamped the same way as the node does
+std::array<qreal, 4> clampedRadii(const Shape& shape)
+{
+    const qreal maximumRadius = std::min(shape.rect.width(), shape.rect.height()) / 2;
+
+    return {std::min(shape.cornerRadius(Qt::TopLeftCorner), maximumRadius),
+            std::min(shape.cornerRadius(Qt::TopRightCorner), maximumRadius),
+            std::min(shape.cornerRadius(Qt::BottomRightCorner), maximumRadius),
+            std::min(shape.cornerRadius(Qt::BottomLeftCorner), maximumRadius)};
+}
+
+QPainterPath referencePath(const Shape& shape)
+{
+    const QRectF& rect = shape.rect;
+    const std::array<qreal, 4> r = clampedRadii(shape);
+
+    QPainterPath path;
+
+    // What the node used to construct, as long as QPainterPath
+    // clamps the radius the same way (it clamps the horizontal
+    // and the vertical radii separately)
+    if (shape.hasSameRadii(Shape {rect, shape.radius}) && qFuzzyCompare(r[0], shape.radius))
+    {
+        path.addRoundedRect(rect, shape.radius, shape.radius);
+        return path.simplified();
+    }
+
+    path.moveTo(rect.left(), rect.top() + r[0]);
+    path.arcTo(QRectF(rect.left(), rect.top(), 2 * r[0], 2 * r[0]), 180, -90);
+    path.lineTo(rect.right() - r[1], rect.top());
+    path.arcTo(QRectF(rect.right() - (2 * r[1]), rect.top(), 2 * r[1], 2 * r[1]), 90, -90);
+    path.lineTo(rect.right(), rect.bottom() - r[2]);
+    path.arcTo(QRectF(rect.right() - (2 * r[2]), rect.bottom() - (2 * r[2]), 2 * r[2], 2 * r[2]), 0, -90);
+    path.lineTo(rect.left() + r[3], rect.bottom());
+    path.arcTo(QRectF(rect.left(), rect.bottom() - (2 * r[3]), 2 * r[3], 2 * r[3]), 270, -90);
+    path.closeSubpath();
+
+    return path;
+}
+
+// Union of the triangles of the geometry. They are all given the
+// same orientation, so that overlapping ones do not cancel out.
+QPainterPath geometryPath(const QSGGeometry& geometry)
+{
+    const QSGGeometry::TexturedPoint2D* const points = geometry.vertexDataAsTexturedPoint2D();
+
+    QPainterPath path;
+    path.setFillRule(Qt::WindingFill);
+
+    const auto addTriangle = [&path, points](const int a, const int b, const int c) {
+        const QPointF pa(points[a].x, points[a].y);
+        QPointF pb(points[b].x, points[b].y);
+        QPointF pc(points[c].x, points[c].y);
+
+        const qreal area = ((pb.x() - pa.x()) * (pc.y() - pa.y())) - ((pb.y() - pa.y()) * (pc.x() - pa.x()));
+        if (qFuzzyIsNull(area))
+            return;
+
+        if (area < 0.0)
+            std::swap(pb, pc);
+
+        path.addPolygon(QPolygonF({pa, pb, pc}));
+        path.closeSubpath();
+    };
+
+    if (geometry.drawingMode() == QSGGeometry::DrawingMode::DrawTriangleStrip)
+    {
+        for (int i = 0; i + 2 < geometry.vertexCount(); ++i)
+            addTriangle(i, i + 1, i + 2);
+    }
+    else
+    {
+        assert(geometry.drawingMode() == QSGGeometry::DrawingMode::DrawTriangles);
+
+        const quint16* const indices = geometry.indexDataAsUShort();
+        for (int i = 0; i + 2 < geometry.indexCount(); i += 3)
+            addTriangle(indices[i], indices[i + 1], indices[i + 2]);
+    }
+
+    return path;
+}
+
+// Model of the fragment shader of the distance field material
+// (shaders/roundedrectangularimage.frag), with the distance in
+// device pixels. Changes to the shader must be made here too.
+void rasterizeDistanceField(QImage& image, const QPoint& origin, const Shape& shape, const qreal devicePixelRatio)
+{
+    const QRectF rect(shape.rect.topLeft() * devicePixelRatio, shape.rect.size() * devicePixelRatio);
+    const QPointF center = rect.center();
+    const QPointF halfSize(rect.width() / 2, rect.height() / 2);
+
+    std::array<qreal, 4> radii = clampedRadii(shape);
+    for (qreal& radius : radii)
+        radius *= devicePixelRatio;
+
+    for (int y = 0; y < image.height(); ++y)
+    {
+        uchar* const line = image.scanLine(y);
+
+        for (int x = 0; x < image.width(); ++x)
+        {
+            const QPointF p = QPointF(origin.x() + x + 0.5, origin.y() + y + 0.5) - center;
+
+            // Top left, top right, bottom right and bottom left
+            const qreal radius = (p.x() < 0.0) ? ((p.y() < 0.0) ? radii[0] : radii[3])
+                                               : ((p.y() < 0.0) ? radii[1] : radii[2]);
+
+            const qreal qx = std::abs(p.x()) - halfSize.x() + radius;
+            const qreal qy = std::abs(p.y()) - halfSize.y() + radius;
+            const qreal distance = std::hypot(std::max(qx, 0.0), std::max(qy, 0.0)) +
+                                   std::min(std::max(qx, qy), 0.0) - radius;
+
+            const qreal coverage = std::clamp(0.5 - distance, 0.0, 1.0);
+            line[x] = static_cast<uchar>(std::lround(coverage * 255));
+        }
+    }
+}
+
+}
+
+QSGRoundedRectangularImageValidation::Result QSGRoundedRectangularImageValidation::compare(const Shape& shape,
+                                                                                            const Tessellation& tessellation,
+                                                                                            const Mode mode,
+                                                                                            const Topology topology)
+{
+    assert(shape.isValid() && tessellation.isValid());
+
+    Result result;
+    QElapsedTimer timer;
+
+    timer.start();
+    const QPainterPath reference = referencePath(shape);
+    result.referenceNanoseconds = timer.nsecsElapsed();
+
+    // In distance field mode, the geometry is a plain rectangle
+    const Shape geometryShape = (mode == Mode::DistanceField) ? Shape {shape.rect, 0.0} : shape;
+
+    timer.start();
+    const std::unique_ptr<QSGGeometry> geometry(QSGRoundedRectangularImageNode::rebuildGeometry(geometryShape,
+                                                                                              nullptr,
+                                                                                              nullptr,
+                                                                                              tessellation,
+                                                                                              topology));
+    result.nodeNanoseconds = timer.nsecsElapsed();
+    assert(geometry);
+
+    // One pixel of margin for antialiasing
+    const qreal devicePixelRatio = tessellation.devicePixelRatio;
+    const QRect deviceRect = QRectF(shape.rect.topLeft() * devicePixelRatio,
+                                    shape.rect.size() * devicePixelRatio).toAlignedRect().adjusted(-1, -1, 1, 1);
+
+    const auto rasterize = [&deviceRect, devicePixelRatio](const QPainterPath& path) {
+        QImage image(deviceRect.size(), QImage::Format_Alpha8);
+        image.fill(0);
+
+        QPainter painter(&image);
+        painter.setRenderHint(QPainter::Antialiasing);
+        painter.translate(-deviceRect.topLeft());
+        painter.scale(devicePixelRatio, devicePixelRatio);
+        painter.fillPath(path, Qt::black);
+
+        return image;
+    };
+
+    const QImage referenceImage = rasterize(reference);
+
+    QImage nodeImage;
+    if (mode == Mode::DistanceField)
+    {
+        nodeImage = QImage(deviceRect.size(), QImage::Format_Alpha8);
+        rasterizeDistanceField(nodeImage, deviceRect.topLeft(), shape, devicePixelRatio);
+    }
+    else
+    {
+        nodeImage = rasterize(geometryPath(*geometry));
+    }
+
+    qint64 referenceCoverage = 0;
+    qint64 difference = 0;
+    int maximumDifference = 0;
+
+    for (int y = 0; y < referenceImage.height(); ++y)
+    {
+        const uchar* const referenceLine = referenceImage.constScanLine(y);
+        const uchar* const nodeLine = nodeImage.constScanLine(y);
+
+        for (int x = 0; x < referenceImage.width(); ++x)
+        {
+            const int pixelDifference = std::abs(referenceLine[x] - nodeLine[x]);
+
+            referenceCoverage += referenceLine[x];
+            difference += pixelDifference;
+            maximumDifference = std::max(maximumDifference, pixelDifference);
+        }
+    }
+
+    result.areaDifference = (referenceCoverage > 0) ? (qreal(difference) / referenceCoverage) : 0.0;
+    result.maximumPixelDifference = maximumDifference / 255.0;
+
+    return result;
+}
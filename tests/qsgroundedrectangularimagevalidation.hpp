@@ -0,0 +1,71 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Fatih Uzunoglu <fuzun54@outlook.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+#ifndef QSGROUNDEDRECTANGULARIMAGEVALIDATION_HPP
+#define QSGROUNDEDRECTANGULARIMAGEVALIDATION_HPP
+
+#include "qsgroundedrectangularimagenode.hpp"
+
+// Compares the coverage of the geometry of a shape against the
+// QPainterPath outline used as the reference, both rasterized with
+// QPainter offscreen, and times how long each takes to construct.
+//
+// In distance field mode, the coverage comes from a C++ model of
+// the fragment shader of QSGRoundedRectangularImageMaterial, not
+// from the shader itself, so only the model is checked. It must be
+// kept in line with shaders/roundedrectangularimage.frag.
+class QSGRoundedRectangularImageValidation
+{
+public:
+    using Shape = QSGRoundedRectangularImageNode::Shape;
+    using Tessellation = QSGRoundedRectangularImageNode::Tessellation;
+    using Mode = QSGRoundedRectangularImageNode::Mode;
+    using Topology = QSGRoundedRectangularImageNode::Topology;
+
+    struct Result
+    {
+        // Sum of the coverage differences of the pixels, relative
+        // to the covered area of the reference
+        qreal areaDifference = 0.0;
+
+        // Largest coverage difference of a single pixel, from 0 to 1.
+        // A straight edge off by a quarter of a pixel differs by 0.25.
+        qreal maximumPixelDifference = 0.0;
+
+        qint64 referenceNanoseconds = 0;
+        qint64 nodeNanoseconds = 0;
+
+        constexpr bool isEquivalent(const qreal areaTolerance = 0.01, const qreal pixelTolerance = 0.25) const
+        {
+            return (areaDifference <= areaTolerance && maximumPixelDifference <= pixelTolerance);
+        }
+    };
+
+    static Result compare(const Shape& shape,
+                          const Tessellation& tessellation = {},
+                          const Mode mode = Mode::Tessellated,
+                          const Topology topology = Topology::TriangleStrip);
+};
+
+#endif // QSGROUNDEDRECTANGULARIMAGEVALIDATION_HPP
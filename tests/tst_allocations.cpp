@@ -0,0 +1,302 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Fatih Uzunoglu <fuzun54@outlook.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "qsgroundedrectangularimagenode.hpp"
+
+#include <QSGGeometry>
+#include <QSGTexture>
+#include <QTest>
+
+#include <cerrno>
+#include <cstdlib>
+#include <memory>
+#include <new>
+
+// Counts the heap allocations of the calling thread while enabled,
+// so that other threads of the process do not disturb the count
+namespace
+{
+
+thread_local bool countingAllocations = false;
+thread_local qint64 allocationCount = 0;
+
+inline void countAllocation()
+{
+    if (countingAllocations)
+        ++allocationCount;
+}
+
+}
+
+#ifdef __GLIBC__
+
+// Replaces malloc() of glibc for the whole process, including Qt
+// (QSGGeometry::allocate(), QVarLengthArray) and operator new of
+// the C++ runtime, which all end up in one of these
+extern "C"
+{
+
+void* __libc_malloc(std::size_t size);
+void* __libc_calloc(std::size_t count, std::size_t size);
+void* __libc_realloc(void* pointer, std::size_t size);
+void* __libc_memalign(std::size_t alignment, std::size_t size);
+void __libc_free(void* pointer);
+
+void* malloc(const std::size_t size) noexcept
+{
+    countAllocation();
+    return __libc_malloc(size);
+}
+
+void* calloc(const std::size_t count, const std::size_t size) noexcept
+{
+    countAllocation();
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* const pointer, const std::size_t size) noexcept
+{
+    countAllocation();
+    return __libc_realloc(pointer, size);
+}
+
+void* memalign(const std::size_t alignment, const std::size_t size) noexcept
+{
+    countAllocation();
+    return __libc_memalign(alignment, size);
+}
+
+void* aligned_alloc(const std::size_t alignment, const std::size_t size) noexcept
+{
+    countAllocation();
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void** const pointer, const std::size_t alignment, const std::size_t size) noexcept
+{
+    countAllocation();
+    *pointer = __libc_memalign(alignment, size);
+    return *pointer ? 0 : ENOMEM;
+}
+
+void free(void* const pointer) noexcept
+{
+    __libc_free(pointer);
+}
+
+}
+
+#else
+
+// Elsewhere only operator new can be replaced portably, which misses
+// the allocations of Qt that use malloc() directly. The statistics of
+// the node are checked as well for that reason.
+void* operator new(const std::size_t size)
+{
+    countAllocation();
+
+    if (void* const pointer = std::malloc(size ? size : 1))
+        return pointer;
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* const pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* const pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+#endif
+
+namespace
+{
+
+using GeometryStatistics = QSGRoundedRectangularImageNode::GeometryStatistics;
+using PathCacheStatistics = QSGRoundedRectangularImageNode::PathCacheStatistics;
+
+struct Allocations
+{
+    qint64 heap = 0;
+    quint64 geometry = 0;
+    quint64 pathCacheMisses = 0;
+};
+
+template<class F>
+Allocations countAllocations(F&& f)
+{
+    const GeometryStatistics geometryStatistics = QSGRoundedRectangularImageNode::geometryStatistics();
+    const PathCacheStatistics pathCacheStatistics = QSGRoundedRectangularImageNode::pathCacheStatistics();
+
+    allocationCount = 0;
+    countingAllocations = true;
+    f();
+    countingAllocations = false;
+
+    Allocations allocations;
+    allocations.heap = allocationCount;
+    allocations.geometry = QSGRoundedRectangularImageNode::geometryStatistics().allocations - geometryStatistics.allocations;
+    allocations.pathCacheMisses = QSGRoundedRectangularImageNode::pathCacheStatistics().misses - pathCacheStatistics.misses;
+    return allocations;
+}
+
+}
+
+using Shape = QSGRoundedRectangularImageNode::Shape;
+using Tessellation = QSGRoundedRectangularImageNode::Tessellation;
+using Topology = QSGRoundedRectangularImageNode::Topology;
+
+Q_DECLARE_METATYPE(Shape)
+Q_DECLARE_METATYPE(Topology)
+
+namespace
+{
+
+class TestTexture : public QSGTexture
+{
+public:
+    qint64 comparisonKey() const override
+    {
+        return static_cast<qint64>(reinterpret_cast<quintptr>(this));
+    }
+
+    QSize textureSize() const override
+    {
+        return {256, 256};
+    }
+
+    bool hasAlphaChannel() const override
+    {
+        return true;
+    }
+
+    bool hasMipmaps() const override
+    {
+        return false;
+    }
+};
+
+}
+
+// Rebuilding a geometry that is large enough, with the arcs of the
+// shape already in the path cache, must not touch the heap
+class tst_Allocations : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void rebuildGeometry_data();
+    void rebuildGeometry();
+    void setShape();
+};
+
+void tst_Allocations::rebuildGeometry_data()
+{
+    QTest::addColumn<Shape>("shape");
+    QTest::addColumn<Topology>("topology");
+
+    const Shape shapes[] = {
+        {QRectF(0.0, 0.0, 120.0, 80.0), 8.0}, // From the compile time table
+        {QRectF(0.0, 0.0, 1000.0, 800.0), 400.0}, // From the path cache
+        {QRectF(0.0, 0.0, 300.0, 100.0), 50.0} // Pill
+    };
+
+    const char* const names[] = {"table", "cache", "pill"};
+
+    for (int i = 0; i < 3; ++i)
+    {
+        QTest::addRow("%s, strip", names[i]) << shapes[i] << Topology::TriangleStrip;
+        QTest::addRow("%s, indexed", names[i]) << shapes[i] << Topology::IndexedTriangles;
+    }
+}
+
+void tst_Allocations::rebuildGeometry()
+{
+    QFETCH(Shape, shape);
+    QFETCH(Topology, topology);
+
+    const Tessellation tessellation {2.0};
+
+    // Builds the geometry and fills the cache, including
+    // the local tier of this thread
+    std::unique_ptr<QSGGeometry> geometry(QSGRoundedRectangularImageNode::rebuildGeometry(shape,
+                                                                                          nullptr,
+                                                                                          nullptr,
+                                                                                          tessellation,
+                                                                                          topology));
+    QVERIFY(geometry);
+
+    QSGGeometry* rebuilt = nullptr;
+    const Allocations allocations = countAllocations([&]() {
+        rebuilt = QSGRoundedRectangularImageNode::rebuildGeometry(shape,
+                                                                  geometry.get(),
+                                                                  nullptr,
+                                                                  tessellation,
+                                                                  topology);
+    });
+
+    QCOMPARE(rebuilt, geometry.get());
+    QCOMPARE(allocations.heap, qint64(0));
+    QCOMPARE(allocations.geometry, quint64(0));
+    QCOMPARE(allocations.pathCacheMisses, quint64(0));
+}
+
+void tst_Allocations::setShape()
+{
+    QSGRoundedRectangularImageNode node;
+    node.setTexture(std::make_shared<TestTexture>());
+
+    // Corners need more segments than the compile time table has
+    node.setTessellation({3.0});
+
+    // The geometry of the first one is large enough for both
+    const Shape shapes[] = {
+        {QRectF(0.0, 0.0, 800.0, 600.0), 200.0},
+        {QRectF(0.0, 0.0, 800.0, 600.0), 160.0}
+    };
+
+    for (const Shape& shape : shapes)
+        QVERIFY(node.setShape(shape));
+
+    QVERIFY(node.setShape(shapes[0]));
+
+    const Allocations allocations = countAllocations([&]() {
+        node.setShape(shapes[1]);
+        node.setShape(shapes[0]);
+    });
+
+    QCOMPARE(node.shape(), shapes[0]);
+    QCOMPARE(allocations.heap, qint64(0));
+    QCOMPARE(allocations.geometry, quint64(0));
+    QCOMPARE(allocations.pathCacheMisses, quint64(0));
+}
+
+QTEST_MAIN(tst_Allocations)
+
+#include "tst_allocations.moc"
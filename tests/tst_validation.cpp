@@ -0,0 +1,147 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Fatih Uzunoglu <fuzun54@outlook.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "qsgroundedrectangularimagevalidation.hpp"
+
+#include <QTest>
+
+using Shape = QSGRoundedRectangularImageNode::Shape;
+using Tessellation = QSGRoundedRectangularImageNode::Tessellation;
+using Mode = QSGRoundedRectangularImageNode::Mode;
+using Topology = QSGRoundedRectangularImageNode::Topology;
+
+Q_DECLARE_METATYPE(Shape)
+Q_DECLARE_METATYPE(Mode)
+Q_DECLARE_METATYPE(Topology)
+
+// Checks the geometry of each shape, and the C++ model of the distance
+// field shader, against the QPainterPath reference, and logs how long
+// each takes to build
+class tst_Validation : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void compare_data();
+    void compare();
+};
+
+void tst_Validation::compare_data()
+{
+    QTest::addColumn<Shape>("shape");
+    QTest::addColumn<qreal>("devicePixelRatio");
+    QTest::addColumn<Mode>("mode");
+    QTest::addColumn<Topology>("topology");
+    QTest::addColumn<qreal>("pixelTolerance");
+
+    struct NamedShape
+    {
+        const char* name;
+        Shape shape;
+    };
+
+    Shape perCorner {QRectF(0.0, 0.0, 120.0, 80.0), 0.0};
+    perCorner.topLeftRadius = 4.0;
+    perCorner.topRightRadius = 20.0;
+    perCorner.bottomRightRadius = 0.0;
+    perCorner.bottomLeftRadius = 36.0;
+
+    Shape perCornerClamped {QRectF(0.0, 0.0, 80.0, 120.0), 10.0};
+    perCornerClamped.topRightRadius = 200.0;
+
+    const NamedShape shapes[] = {
+        {"small radius", {QRectF(0.0, 0.0, 120.0, 80.0), 4.0}},
+        {"radius", {QRectF(0.0, 0.0, 120.0, 80.0), 16.0}},
+        {"large radius", {QRectF(0.0, 0.0, 300.0, 200.0), 80.0}},
+        {"fractional position", {QRectF(10.25, 7.5, 100.5, 60.75), 12.0}},
+        {"per-corner radii", perCorner},
+        {"per-corner radii, clamped", perCornerClamped},
+        {"horizontal pill", {QRectF(0.0, 0.0, 200.0, 60.0), 30.0}},
+        {"vertical pill", {QRectF(0.0, 0.0, 40.0, 160.0), 20.0}},
+        {"pill, clamped", {QRectF(0.0, 0.0, 200.0, 60.0), 1000.0}},
+        {"circle", {QRectF(0.0, 0.0, 100.0, 100.0), 50.0}},
+        {"small circle", {QRectF(0.0, 0.0, 12.0, 12.0), 6.0}}
+    };
+
+    // Geometry is within the tessellation tolerance of the arcs,
+    // and the reference arcs are cubic Bezier approximations off
+    // by up to 0.03% of the radius. The distance field coverage
+    // ramps linearly across the edge, which differs by up to about
+    // 0.2 from the exact area at sharp corners.
+    struct Variant
+    {
+        const char* name;
+        Mode mode;
+        Topology topology;
+        qreal pixelTolerance;
+    };
+
+    const Variant variants[] = {
+        {"strip", Mode::Tessellated, Topology::TriangleStrip, 0.2},
+        {"indexed", Mode::Tessellated, Topology::IndexedTriangles, 0.2},
+        {"distance field model", Mode::DistanceField, Topology::TriangleStrip, 0.25}
+    };
+
+    for (const NamedShape& shape : shapes)
+    {
+        for (const qreal devicePixelRatio : {1.0, 2.0, 3.0})
+        {
+            for (const Variant& variant : variants)
+            {
+                QTest::addRow("%s @%gx, %s", shape.name, devicePixelRatio, variant.name)
+                    << shape.shape << devicePixelRatio << variant.mode << variant.topology << variant.pixelTolerance;
+            }
+        }
+    }
+}
+
+void tst_Validation::compare()
+{
+    QFETCH(Shape, shape);
+    QFETCH(qreal, devicePixelRatio);
+    QFETCH(Mode, mode);
+    QFETCH(Topology, topology);
+    QFETCH(qreal, pixelTolerance);
+
+    const Tessellation tessellation {devicePixelRatio, 0.1};
+
+    const QSGRoundedRectangularImageValidation::Result result =
+        QSGRoundedRectangularImageValidation::compare(shape, tessellation, mode, topology);
+
+    qInfo("area difference %.5f, maximum pixel difference %.3f, reference %lld ns, node %lld ns",
+          result.areaDifference,
+          result.maximumPixelDifference,
+          static_cast<long long>(result.referenceNanoseconds),
+          static_cast<long long>(result.nodeNanoseconds));
+
+    QVERIFY2(result.isEquivalent(0.01, pixelTolerance),
+             qPrintable(QStringLiteral("area difference %1, maximum pixel difference %2")
+                            .arg(result.areaDifference)
+                            .arg(result.maximumPixelDifference)));
+}
+
+QTEST_MAIN(tst_Validation)
+
+#include "tst_validation.moc"